@@ -0,0 +1,142 @@
+/*
+    helpers shared by the benchmark programs. every benchmark is a standalone program that
+    compares the old and the new way of doing one thing; make bench builds and runs them all.
+    the first argument, if given, scales the generated input.
+    heap use is counted by replacing the global operator new, which needs glibc.
+*/
+
+#ifndef JSON_BENCH_H
+#define JSON_BENCH_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include <malloc.h>
+#include "../src/json.h"
+
+// ========== heap counting
+
+static atomic<size_t> benchAllocations{0};
+static atomic<size_t> benchLiveBytes{0};
+
+// kept out of line, gcc otherwise warns about free() of memory from operator new
+__attribute__((noinline)) void *operator new(size_t n)
+{
+    void *p = malloc(n ? n : 1);
+    if (p == nullptr)
+        throw bad_alloc();
+    benchAllocations.fetch_add(1, memory_order_relaxed);
+    benchLiveBytes.fetch_add(malloc_usable_size(p), memory_order_relaxed);
+    return p;
+}
+
+__attribute__((noinline)) void operator delete(void *p) noexcept
+{
+    if (p)
+        benchLiveBytes.fetch_sub(malloc_usable_size(p), memory_order_relaxed);
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    operator delete(p);
+}
+
+// the allocations and the growth of the heap since it was created
+class BenchHeap
+{
+private:
+    size_t allocations = benchAllocations;
+    size_t bytes = benchLiveBytes;
+
+public:
+    size_t allocationCount() const { return benchAllocations - allocations; }
+    long long liveBytes() const { return (long long)benchLiveBytes - (long long)bytes; }
+};
+
+// ========== timing
+
+// keeps the optimizer from dropping a result
+static volatile size_t benchSink = 0;
+
+// the scale argument, or def
+inline size_t benchScale(int argc, char **argv, size_t def)
+{
+    return argc > 1 ? size_t(atol(argv[1])) : def;
+}
+
+// best of repeat runs of f, in seconds
+template <class F>
+double benchTime(F &&f, int repeat = 5)
+{
+    double best = 1e30;
+    for (int i = 0; i < repeat; i++)
+    {
+        auto start = chrono::steady_clock::now();
+        f();
+        best = min(best, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+// the allocations of one run of f
+template <class F>
+size_t benchAllocationsOf(F &&f)
+{
+    BenchHeap heap;
+    f();
+    return heap.allocationCount();
+}
+
+// one line of results, with the throughput if bytes is given
+inline void benchReport(const string &name, double seconds, size_t bytes = 0)
+{
+    cout << "  " << left << setw(40) << name << right << fixed << setprecision(3) << setw(10) << seconds * 1e3 << " ms";
+    if (bytes)
+        cout << setprecision(1) << setw(10) << bytes / seconds / 1e6 << " MB/s";
+    cout << endl;
+}
+
+// ========== input
+
+// an array of n records with strings, numbers, nested objects and arrays, all records
+// having the same keys like the logs and api responses this library is mostly fed
+inline string benchRecords(size_t n)
+{
+    string s = "[";
+    char buf[512];
+    for (size_t i = 0; i < n; i++)
+    {
+        snprintf(buf, sizeof(buf),
+                 "%s\n{\"id\":%zu,\"name\":\"user %zu\",\"email\":\"user%zu@example.com\",\"active\":%s,"
+                 "\"score\":%.4f,\"balance\":%zu.%02zu,\"created\":%zu,\"tags\":[\"t%zu\",\"t%zu\",\"t%zu\"],"
+                 "\"address\":{\"street\":\"%zu Main Street\",\"city\":\"City %zu\",\"zip\":\"%05zu\"},"
+                 "\"note\":\"line one\\nline \\\"two\\\"\"}",
+                 i ? "," : "", i, i, i, i % 3 ? "true" : "false", i * 0.6180339887 + 1.0 / (i + 3), i * 37 % 100000,
+                 i % 100, 1600000000000 + i * 1000003, i % 7, i % 11, i % 13, i % 1000, i % 97, i * 7 % 100000);
+        s += buf;
+    }
+    return s + "\n]";
+}
+
+// a file holding text, removed when the object goes away
+class BenchFile
+{
+private:
+    string filepath;
+
+public:
+    BenchFile(const string &name, const string &text) : filepath("build/" + name)
+    {
+        ofstream out(filepath, ios::binary);
+        out << text;
+    }
+    ~BenchFile() { remove(filepath.c_str()); }
+
+    const string &path() const { return filepath; }
+};
+
+#endif // JSON_BENCH_H
@@ -0,0 +1,78 @@
+// building trees in code: copying finished values into place against moving them there.
+// the copying build is how a tree had to be assembled before Json was move-aware
+
+#define JSON_COUNT_ALLOCATIONS
+#include "bench.h"
+
+// the parts are made and handed over by const reference as between the functions of a
+// program. kept out of line, or gcc warns about the branches for the types a part cannot have
+__attribute__((noinline)) static Json part(string s)
+{
+    return Json(std::move(s));
+}
+__attribute__((noinline)) static void copyInto(Json &arr, const Json &value)
+{
+    arr.push_back(value);
+}
+__attribute__((noinline)) static void copyInto(Json &obj, string_view key, const Json &value)
+{
+    obj[key] = value;
+}
+
+// a record assembled from parts, each copied into its parent
+static Json copiedRecord(size_t i)
+{
+    Json tags = JsonArray();
+    for (size_t k = 0; k < 8; k++)
+        copyInto(tags, part("tag " + to_string(k)));
+    Json address = JsonObject();
+    copyInto(address, "city", part("City " + to_string(i % 97)));
+    Json record = JsonObject();
+    copyInto(record, "id", Json(int(i)));
+    copyInto(record, "name", part("user " + to_string(i)));
+    copyInto(record, "tags", tags);
+    copyInto(record, "address", address);
+    return record;
+}
+
+// the same record with every part moved into place
+static Json movedRecord(size_t i)
+{
+    Json tags = JsonArray();
+    tags.reserve(8);
+    for (size_t k = 0; k < 8; k++)
+        tags.emplace_back(string("tag ") + to_string(k));
+    Json address = JsonObject();
+    address.try_emplace("city", string("City ") + to_string(i % 97));
+    Json record = JsonObject();
+    record.try_emplace("id", int(i));
+    record.try_emplace("name", "user " + to_string(i));
+    record.try_emplace("tags", std::move(tags));
+    record.try_emplace("address", std::move(address));
+    return record;
+}
+
+template <class Build>
+static void run(const char *name, size_t n, Build build)
+{
+    size_t copies = 0;
+    double seconds = benchTime([&] {
+        size_t before = jsonPayloadCopies;
+        Json root = JsonArray();
+        for (size_t i = 0; i < n; i++)
+            root.push_back(build(i));
+        copies = jsonPayloadCopies - before;
+        benchSink += root.size();
+    });
+    benchReport(name, seconds);
+    cout << "    " << copies << " payload copies" << endl;
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = benchScale(argc, argv, 50000);
+    cout << "bench_build: " << n << " records" << endl;
+    run("copied into place", n, copiedRecord);
+    run("moved into place", n, movedRecord);
+    return 0;
+}
@@ -0,0 +1,30 @@
+// reading the same files over and over: readJson every time against a JsonCache
+
+#include "bench.h"
+#include "../src/json_cache.h"
+
+int main(int argc, char **argv)
+{
+    size_t n = benchScale(argc, argv, 500);
+    vector<unique_ptr<BenchFile>> files;
+    for (size_t i = 0; i < 8; i++)
+        files.emplace_back(new BenchFile("bench_cache_" + to_string(i) + ".json", benchRecords(n + i)));
+    const size_t reads = 100;
+    cout << "bench_cache: " << reads << " reads of " << files.size() << " files of about " << n << " records" << endl;
+
+    benchReport("readJson", benchTime([&] {
+                    for (size_t i = 0; i < reads; i++)
+                        benchSink += readJson(files[i % files.size()]->path()).getJson().size();
+                }, 3));
+
+    JsonCache cache;
+    auto cached = [&] {
+        for (size_t i = 0; i < reads; i++)
+            benchSink += cache.read(files[i % files.size()]->path())->size();
+    };
+    benchReport("JsonCache, starting empty", benchTime(cached, 1));
+    benchReport("JsonCache, every file cached", benchTime(cached, 3));
+    JsonCache::Stats stats = cache.getStats();
+    cout << "    " << stats.hits << " hits, " << stats.misses << " misses, " << stats.bytes << " bytes cached" << endl;
+    return 0;
+}
@@ -0,0 +1,20 @@
+// the same tree as cbor and as json text: encoded size, encoding and decoding time
+
+#include "bench.h"
+#include "../src/json_cbor.h"
+
+int main(int argc, char **argv)
+{
+    size_t n = benchScale(argc, argv, 20000);
+    Json tree = parseJson(benchRecords(n)).takeJson();
+    string text = tree.dump(0, "");
+    string bin = dumpCbor(tree);
+    cout << "bench_cbor: " << n << " records, " << text.size() << " bytes of compact json, " << bin.size()
+         << " bytes of cbor (" << fixed << setprecision(1) << 100.0 * bin.size() / text.size() << "%)" << endl;
+
+    benchReport("dump, compact", benchTime([&] { benchSink += tree.dump(0, "").size(); }), text.size());
+    benchReport("dumpCbor", benchTime([&] { benchSink += dumpCbor(tree).size(); }), bin.size());
+    benchReport("parseJson", benchTime([&] { benchSink += parseJson(text).getJson().size(); }), text.size());
+    benchReport("parseCbor", benchTime([&] { benchSink += parseCbor(bin).getJson().size(); }), bin.size());
+    return 0;
+}
@@ -0,0 +1,33 @@
+// copying a parsed tree and changing one value of the copy. copies are deep unless this
+// program was built with JSON_COPY_ON_WRITE, then they share the tree until it is modified
+
+#include "bench.h"
+
+int main(int argc, char **argv)
+{
+    size_t n = benchScale(argc, argv, 20000);
+    Json tree = parseJson(benchRecords(n)).takeJson();
+#ifdef JSON_COPY_ON_WRITE
+    string mode = "shared copies";
+#else
+    string mode = "deep copies";
+#endif
+    cout << "bench_cow: " << n << " records, " << mode << endl;
+
+    benchReport("copy", benchTime([&] {
+                    Json copy = tree;
+                    benchSink += copy.size();
+                }));
+    // only the path down to the changed value is copied when the tree is shared
+    size_t middle = n / 2;
+    benchReport("copy, then change one city", benchTime([&] {
+                    Json copy = tree;
+                    copy[middle]["address"]["city"] = "Elsewhere";
+                    benchSink += copy.size();
+                }));
+    cout << "    " << benchAllocationsOf([&] {
+        Json copy = tree;
+        copy[middle]["address"]["city"] = "Elsewhere";
+    }) << " allocations for the copy and the change" << endl;
+    return 0;
+}
@@ -0,0 +1,35 @@
+// parse and drop: a heap allocated Json tree against an arena backed JsonDocument
+
+#include "bench.h"
+#include "../src/json_document.h"
+
+int main(int argc, char **argv)
+{
+    size_t n = benchScale(argc, argv, 20000);
+    string text = benchRecords(n);
+    cout << "bench_document: " << n << " records, " << text.size() << " bytes" << endl;
+
+    BenchHeap treeHeap;
+    Json tree = parseJson(text).takeJson();
+    long long treeBytes = treeHeap.liveBytes();
+    size_t treeAllocations = treeHeap.allocationCount();
+    tree = Json();
+
+    JsonDocument doc;
+    BenchHeap docHeap;
+    doc.parse(text);
+    long long docBytes = docHeap.liveBytes();
+    size_t docAllocations = docHeap.allocationCount();
+
+    benchReport("parseJson and drop", benchTime([&] { benchSink += parseJson(text).getJson().size(); }), text.size());
+    benchReport("JsonDocument parse and drop", benchTime([&] {
+                    doc.parse(text);
+                    benchSink += doc.root().size();
+                    doc.clear();
+                }),
+                text.size());
+
+    cout << "  Json tree:    " << setw(8) << treeAllocations << " allocations, " << setw(10) << treeBytes << " bytes" << endl;
+    cout << "  JsonDocument: " << setw(8) << docAllocations << " allocations, " << setw(10) << docBytes << " bytes" << endl;
+    return 0;
+}
@@ -0,0 +1,53 @@
+// printing numbers: the old ostringstream output of dump() against appendJsonDouble.
+// ostringstream kept only 6 significant digits, so it also lost precision
+
+#include "bench.h"
+
+static void oldAppendDouble(string &out, double d)
+{
+    std::ostringstream strs;
+    strs << d;
+    out += strs.str();
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = benchScale(argc, argv, 300000);
+    vector<double> values;
+    uint64_t x = 88172645463325252ull;
+    for (size_t i = 0; i < n; i++)
+    {
+        x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+        values.push_back(i % 2 ? double(x % 10000000) / 1000.0 : double(x >> 11) * 0x1p-53 * 1e6);
+    }
+    cout << "bench_dump_numbers: " << n << " doubles" << endl;
+
+    string out;
+    benchReport("ostringstream", benchTime([&] {
+                    out.clear();
+                    for (double d : values)
+                        oldAppendDouble(out, d), out += ',';
+                    benchSink += out.size();
+                }));
+    size_t lost = 0;
+    for (size_t i = 0, start = 0; i < n; i++)
+    {
+        size_t comma = out.find(',', start);
+        lost += stod(out.substr(start, comma - start)) != values[i];
+        start = comma + 1;
+    }
+
+    benchReport("appendJsonDouble", benchTime([&] {
+                    out.clear();
+                    for (double d : values)
+                        appendJsonDouble(out, d), out += ',';
+                    benchSink += out.size();
+                }));
+
+    Json array = JsonArray();
+    for (double d : values)
+        array.push_back(d);
+    benchReport("dump() of the doubles as an array", benchTime([&] { benchSink += array.dump().size(); }));
+    cout << "  values that ostringstream did not read back exactly: " << lost << " of " << n << endl;
+    return 0;
+}
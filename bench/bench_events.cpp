@@ -0,0 +1,55 @@
+// summing a field of every record: through a parsed tree against a JsonEventParser handler
+
+#include "bench.h"
+
+// adds up the "score" members
+struct ScoreSum : JsonHandler
+{
+    double sum = 0;
+    bool nextIsScore = false;
+
+    bool onKey(string_view key)
+    {
+        nextIsScore = key == "score";
+        return true;
+    }
+    bool onNumber(const Json &num)
+    {
+        if (nextIsScore)
+            sum += num.getDouble();
+        return true;
+    }
+};
+
+int main(int argc, char **argv)
+{
+    size_t n = benchScale(argc, argv, 20000);
+    string text = benchRecords(n);
+    cout << "bench_events: " << n << " records, " << text.size() << " bytes" << endl;
+
+    double treeSum = 0, eventSum = 0;
+    long long treeBytes = 0, eventBytes = 0;
+    benchReport("parseJson", benchTime([&] {
+                    BenchHeap heap;
+                    Json json = parseJson(text).takeJson();
+                    treeSum = 0;
+                    for (const Json &record : json.getArray())
+                        treeSum += record["score"].getDouble();
+                    treeBytes = heap.liveBytes();
+                }),
+                text.size());
+    benchReport("JsonEventParser", benchTime([&] {
+                    BenchHeap heap;
+                    JsonEventParser<ScoreSum> parser;
+                    ScoreSum handler;
+                    parser.parse(text, handler);
+                    eventSum = handler.sum;
+                    eventBytes = heap.liveBytes();
+                }),
+                text.size());
+
+    cout << "  heap in use after parsing, tree: " << treeBytes << " bytes, events: " << eventBytes << " bytes" << endl;
+    if (treeSum != eventSum)
+        cout << "  the sums differ: " << treeSum << " and " << eventSum << endl;
+    return 0;
+}
@@ -0,0 +1,33 @@
+// opening a large dataset and reading values: readJson against a mapped JsonFlatFile.
+// both files are in the page cache, a cold start adds the disk reads of the pages touched
+
+#include "bench.h"
+#include "../src/json_flat.h"
+
+int main(int argc, char **argv)
+{
+    size_t n = benchScale(argc, argv, 20000);
+    string text = benchRecords(n);
+    BenchFile json("bench_flat.json", text);
+    BenchFile flat("bench_flat.jsonf", dumpJsonFlat(parseJson(text).getJson()));
+    cout << "bench_flat: " << n << " records, " << text.size() << " bytes of json, "
+         << JsonFileBuffer(flat.path()).size() << " bytes flat" << endl;
+
+    size_t last = n - 1;
+    benchReport("readJson, one value", benchTime([&] {
+                    Json all = readJson(json.path()).takeJson();
+                    benchSink += all[last]["address"]["city"].getString().size();
+                }));
+    benchReport("JsonFlatFile, one value", benchTime([&] {
+                    JsonFlatFile file;
+                    file.read(flat.path());
+                    benchSink += file[last]["address"]["city"].getString().size();
+                }));
+    benchReport("JsonFlatFile, one value of each", benchTime([&] {
+                    JsonFlatFile file;
+                    file.read(flat.path());
+                    for (size_t i = 0; i < n; i++)
+                        benchSink += file[i]["address"]["city"].getString().size();
+                }));
+    return 0;
+}
@@ -0,0 +1,23 @@
+// the recursive descent parseJson against the two-stage parseJsonIndexed,
+// on compact input and on the same document indented by dump()
+
+#include "bench.h"
+#include "../src/json_index.h"
+
+static void run(const string &name, const string &text)
+{
+    cout << "bench_index: " << name << ", " << text.size() << " bytes" << endl;
+    JsonStructuralIndex index;
+    benchReport("parseJson", benchTime([&] { benchSink += parseJson(text).getJson().size(); }), text.size());
+    benchReport("stage one only", benchTime([&] { benchSink += index.build(text); }), text.size());
+    benchReport("parseJsonIndexed", benchTime([&] { benchSink += parseJsonIndexed(text).getJson().size(); }), text.size());
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = benchScale(argc, argv, 20000);
+    string text = benchRecords(n);
+    run(to_string(n) + " records", text);
+    run("the records indented", parseJson(text).getJson().dump());
+    return 0;
+}
@@ -0,0 +1,53 @@
+// JsonDocument with and without interned keys, on records whose keys are too long
+// to be kept inside their nodes
+
+#include "bench.h"
+#include "../src/json_document.h"
+
+static const char *longKeys[] = {"customer_identifier", "registration_timestamp", "preferred_language_code",
+                                 "last_successful_login", "subscription_tier_name", "marketing_opt_in_status"};
+
+static string records(size_t n)
+{
+    string s = "[";
+    for (size_t i = 0; i < n; i++)
+    {
+        s += i ? ",{" : "{";
+        for (size_t k = 0; k < 6; k++)
+            s += (k ? ",\"" : "\"") + string(longKeys[k]) + "\":" + to_string(i * 6 + k);
+        s += "}";
+    }
+    return s + "]";
+}
+
+static void run(const string &text, size_t n, bool intern)
+{
+    JsonDocument doc;
+    doc.setInternKeys(intern);
+    string name = intern ? "interned keys" : "copied keys";
+    benchReport(name + ", parse", benchTime([&] { benchSink += doc.parse(text); }), text.size());
+
+    // keys from keyAt() of one record find the shared key by its address
+    vector<string_view> keys;
+    for (size_t k = 0; k < 6; k++)
+        keys.push_back(doc[0].keyAt(k));
+    benchReport(name + ", find every key", benchTime([&] {
+                    size_t sum = 0;
+                    JsonElement root = doc.root();
+                    for (size_t i = 0; i < n; i++)
+                        for (string_view key : keys)
+                            sum += root[i][key].getInt();
+                    benchSink += sum;
+                }));
+    cout << "    " << doc.bytesUsed() << " arena bytes" << endl;
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = benchScale(argc, argv, 100000);
+    string text = records(n);
+    cout << "bench_intern: " << n << " records, " << text.size() << " bytes" << endl;
+    run(text, n, false);
+    run(text, n, true);
+    return 0;
+}
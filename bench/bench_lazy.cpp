@@ -0,0 +1,32 @@
+// reading a few values of a large document: a full parseJson against a LazyJsonDocument
+
+#include "bench.h"
+#include "../src/json_lazy.h"
+
+int main(int argc, char **argv)
+{
+    size_t n = benchScale(argc, argv, 20000);
+    string text = benchRecords(n);
+    size_t last = n - 1;
+    cout << "bench_lazy: " << n << " records, " << text.size() << " bytes" << endl;
+
+    benchReport("parseJson, one value", benchTime([&] {
+                    Json json = parseJson(text).takeJson();
+                    benchSink += json[last]["address"]["city"].getString().size();
+                }),
+                text.size());
+    LazyJsonDocument doc;
+    benchReport("LazyJsonDocument, one value", benchTime([&] {
+                    doc.parse(text);
+                    benchSink += doc[last]["address"]["city"].getString().size();
+                }),
+                text.size());
+    // array elements are found by hopping over their siblings, so only a few are read
+    benchReport("LazyJsonDocument, ten values", benchTime([&] {
+                    doc.parse(text);
+                    for (size_t i = 0; i < 10; i++)
+                        benchSink += doc[i * n / 10]["address"]["city"].getString().size();
+                }),
+                text.size());
+    return 0;
+}
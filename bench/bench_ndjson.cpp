@@ -0,0 +1,48 @@
+// reading json lines: a getline and parseJson loop against JsonLinesReader on 1 to 8 threads
+
+#include "bench.h"
+#include "../src/json_ndjson.h"
+
+// the records of benchRecords, one per line
+static string lines(size_t n)
+{
+    string array = benchRecords(n), res;
+    istringstream in(array);
+    string line;
+    while (getline(in, line))
+        if (line.size() > 1)
+            res.append(line, 0, line.back() == ',' ? line.size() - 1 : line.size()) += '\n';
+    return res;
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = benchScale(argc, argv, 40000);
+    BenchFile file("bench_ndjson.ndjson", lines(n));
+    size_t bytes = JsonFileBuffer(file.path()).size();
+    cout << "bench_ndjson: " << n << " lines, " << bytes << " bytes, " << thread::hardware_concurrency() << " cores" << endl;
+
+    benchReport("getline and parseJson", benchTime([&] {
+                    ifstream in(file.path());
+                    string line;
+                    size_t ids = 0;
+                    while (getline(in, line))
+                        ids += parseJson(line).getJson()["id"].getInt();
+                    benchSink += ids;
+                }, 3),
+                bytes);
+    for (size_t threads : {1, 2, 4, 8})
+    {
+        benchReport("JsonLinesReader, " + to_string(threads) + " threads", benchTime([&] {
+                        size_t ids = 0;
+                        JsonLinesReader reader([&](size_t, ParseResult &res) {
+                            ids += res.getJson()["id"].getInt();
+                            return true;
+                        }, threads);
+                        reader.read(file.path());
+                        benchSink += ids;
+                    }, 3),
+                    bytes);
+    }
+    return 0;
+}
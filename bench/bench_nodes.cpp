@@ -0,0 +1,235 @@
+// memory and traversal of parsed documents: the heap Json tree, the 24 byte document
+// nodes used before short strings were kept inline, and the current 16 byte JsonNode
+
+#include "bench.h"
+#include "../src/json_document.h"
+
+// the earlier document node, every string is a pointer to its bytes elsewhere
+struct OldNode
+{
+    Json::JsonType type;
+    size_t size;
+    union
+    {
+        int64_t iValue;
+        double dValue;
+        const char *sValue;
+        const OldNode *children;
+    };
+};
+
+// a copy of a document in the old layout, children and strings in reserved pools
+class OldDocument
+{
+private:
+    vector<OldNode> nodes;
+    string strings;
+
+    // the child nodes and string bytes below e
+    static void measure(JsonElement e, size_t &nodeCount, size_t &stringBytes)
+    {
+        if (e.isString())
+            stringBytes += e.getString().size() + 1;
+        if (!e.isArray() && !e.isObject())
+            return;
+        nodeCount += e.isObject() ? 2 * e.size() : e.size();
+        for (size_t i = 0; i < e.size(); i++)
+        {
+            if (e.isObject())
+                stringBytes += e.keyAt(i).size() + 1;
+            measure(e.isObject() ? e.valueAt(i) : e[i], nodeCount, stringBytes);
+        }
+    }
+
+    const char *keep(string_view s)
+    {
+        const char *p = strings.data() + strings.size();
+        strings.append(s.data(), s.size()).push_back('\0');
+        return p;
+    }
+
+    void copy(JsonElement e, OldNode &out)
+    {
+        out.type = e.getType();
+        out.size = 0;
+        out.iValue = 0;
+        if (e.isString())
+        {
+            out.size = e.getString().size();
+            out.sValue = keep(e.getString());
+        }
+        else if (e.isInt())
+            out.iValue = e.getInt();
+        else if (e.isInt64())
+            out.iValue = e.getInt64();
+        else if (e.isUInt64())
+            out.iValue = int64_t(e.getUInt64());
+        else if (e.isDouble())
+            out.dValue = e.getDouble();
+        else if (e.isBool())
+            out.iValue = e.getBool();
+        else if (e.isArray() || e.isObject())
+        {
+            out.size = e.size();
+            size_t span = e.isObject() ? 2 * e.size() : e.size();
+            size_t first = nodes.size();
+            nodes.resize(first + span);
+            out.children = nodes.data() + first;
+            for (size_t i = 0; i < e.size(); i++)
+            {
+                if (e.isArray())
+                {
+                    copy(e[i], nodes[first + i]);
+                    continue;
+                }
+                OldNode &key = nodes[first + 2 * i];
+                key.type = Json::JsonType::JT_STRING;
+                key.size = e.keyAt(i).size();
+                key.sValue = keep(e.keyAt(i));
+                copy(e.valueAt(i), nodes[first + 2 * i + 1]);
+            }
+        }
+    }
+
+public:
+    OldNode root;
+
+    explicit OldDocument(JsonElement e)
+    {
+        size_t nodeCount = 0, stringBytes = 0;
+        measure(e, nodeCount, stringBytes);
+        nodes.reserve(nodeCount);
+        strings.reserve(stringBytes);
+        copy(e, root);
+    }
+
+    size_t bytes() const { return nodes.size() * sizeof(OldNode) + strings.size(); }
+    size_t nodeCount() const { return nodes.size(); }
+};
+
+// ========== traversal, every scalar and string length added up
+
+static double walk(const OldNode &n)
+{
+    switch (n.type)
+    {
+    case Json::JsonType::JT_STRING:
+        return n.size + n.sValue[0];
+    case Json::JsonType::JT_DOUBLE:
+        return n.dValue;
+    case Json::JsonType::JT_ARRAY:
+    case Json::JsonType::JT_OBJECT:
+    {
+        double sum = 0;
+        size_t span = n.type == Json::JsonType::JT_OBJECT ? 2 * n.size : n.size;
+        for (size_t i = 0; i < span; i++)
+            sum += walk(n.children[i]);
+        return sum;
+    }
+    default:
+        return double(n.iValue);
+    }
+}
+
+static double walk(JsonElement e)
+{
+    switch (e.getType())
+    {
+    case Json::JsonType::JT_STRING:
+        return e.getString().size() + e.getString()[0];
+    case Json::JsonType::JT_DOUBLE:
+        return e.getDouble();
+    case Json::JsonType::JT_ARRAY:
+    {
+        double sum = 0;
+        for (size_t i = 0; i < e.size(); i++)
+            sum += walk(e[i]);
+        return sum;
+    }
+    case Json::JsonType::JT_OBJECT:
+    {
+        double sum = 0;
+        for (size_t i = 0; i < e.size(); i++)
+            sum += e.keyAt(i).size() + e.keyAt(i)[0] + walk(e.valueAt(i));
+        return sum;
+    }
+    case Json::JsonType::JT_BOOL:
+        return e.getBool();
+    case Json::JsonType::JT_INT:
+        return e.getInt();
+    case Json::JsonType::JT_INT64:
+        return double(e.getInt64());
+    case Json::JsonType::JT_UINT64:
+        return double(int64_t(e.getUInt64()));
+    default:
+        return 0;
+    }
+}
+
+static double walk(const Json &json)
+{
+    switch (json.getType())
+    {
+    case Json::JsonType::JT_STRING:
+        return json.getString().size() + json.getString()[0];
+    case Json::JsonType::JT_DOUBLE:
+        return json.getDouble();
+    case Json::JsonType::JT_ARRAY:
+    {
+        double sum = 0;
+        for (const Json &elem : json.getArray())
+            sum += walk(elem);
+        return sum;
+    }
+    case Json::JsonType::JT_OBJECT:
+    {
+        double sum = 0;
+        for (const auto &member : json.getObject())
+            sum += member.first.size() + member.first[0] + walk(member.second);
+        return sum;
+    }
+    case Json::JsonType::JT_BOOL:
+        return json.getBool();
+    case Json::JsonType::JT_INT:
+        return json.getInt();
+    case Json::JsonType::JT_INT64:
+        return double(json.getInt64());
+    case Json::JsonType::JT_UINT64:
+        return double(int64_t(json.getUInt64()));
+    default:
+        return 0;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = benchScale(argc, argv, 20000);
+    string text = benchRecords(n);
+
+    BenchHeap heap;
+    Json tree = parseJson(text).takeJson();
+    long long treeBytes = heap.liveBytes();
+    JsonDocument doc, plainDoc;
+    doc.parse(text);
+    plainDoc.setInternKeys(false);
+    plainDoc.parse(text);
+    OldDocument old(doc.root());
+    size_t values = old.nodeCount() + 1;
+    cout << "bench_nodes: " << n << " records, " << values << " values and keys" << endl;
+
+    cout << fixed << setprecision(1);
+    cout << "  bytes per value, Json tree:                   " << double(treeBytes) / values << endl;
+    cout << "  bytes per value, 24 byte nodes:               " << double(old.bytes()) / values << endl;
+    cout << "  bytes per value, JsonNode:                    " << double(plainDoc.bytesUsed()) / values << endl;
+    cout << "  bytes per value, JsonNode with interned keys: " << double(doc.bytesUsed()) / values << endl;
+
+    double sums[3];
+    benchReport("walk the Json tree", benchTime([&] { sums[0] = walk(tree); }));
+    benchReport("walk the 24 byte nodes", benchTime([&] { sums[1] = walk(old.root); }));
+    benchReport("walk the JsonNodes", benchTime([&] { sums[2] = walk(doc.root()); }));
+    // the tree walks its members in key order, so only the two node layouts add up alike
+    if (sums[1] != sums[2])
+        cout << "  the node walks differ: " << sums[1] << " " << sums[2] << endl;
+    benchSink += size_t(sums[0]);
+    return 0;
+}
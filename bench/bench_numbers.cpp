@@ -0,0 +1,109 @@
+// number conversion: the old istringstream based parseNumber against parseJsonNumber
+
+#include "bench.h"
+
+// how parseNumber used to convert a scanned number, first is at its first character
+static const char *oldParseNumber(const char *first, const char *last, Json &out)
+{
+    const char *p = first + 1; // - or + or some digit
+    bool isInt = true;
+    while (p != last && isdigit(*p))
+        p++;
+    if (p != last && *p == '.')
+    {
+        isInt = false;
+        p++;
+        while (p != last && isdigit(*p))
+            p++;
+    }
+    if (p != last && (*p == 'e' || *p == 'E'))
+    {
+        isInt = false;
+        p++;
+        while (p != last && isdigit(*p))
+            p++;
+    }
+    istringstream sin(string(first, p));
+    if (isInt)
+    {
+        int d;
+        sin >> d;
+        out = d;
+    }
+    else
+    {
+        double d;
+        sin >> d;
+        out = d;
+    }
+    return p;
+}
+
+// n numbers separated by commas, every third one a short int, a 64-bit id or a double
+static string numbers(size_t n)
+{
+    string s;
+    uint64_t x = 88172645463325252ull;
+    for (size_t i = 0; i < n; i++)
+    {
+        x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+        if (i % 3 == 0)
+            s += to_string(int(x % 100000));
+        else if (i % 3 == 1)
+            s += to_string(x >> 1);
+        else
+            s += to_string(double(x % 10000000) / 1000.0);
+        s += ',';
+    }
+    return s;
+}
+
+// n coordinates printed with 15 to 17 significant digits as in canada.json. the 16 and 17
+// digit ones are too long for the fast path of parseJsonNumber and go through from_chars
+static string coordinates(size_t n)
+{
+    string s;
+    uint64_t x = 88172645463325252ull;
+    char buf[32];
+    for (size_t i = 0; i < n; i++)
+    {
+        x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+        double d = (i % 2 ? 180.0 : 90.0) * (double(x >> 11) / double(uint64_t(1) << 53) * 2 - 1);
+        snprintf(buf, sizeof(buf), "%.*g,", int(15 + i % 3), d);
+        s += buf;
+    }
+    return s;
+}
+
+// converts every number of text with parse, returns how many there were
+template <class Parse>
+static size_t convertAll(const string &text, Parse parse)
+{
+    const char *p = text.data(), *last = p + text.size();
+    size_t count = 0;
+    Json num;
+    while (p != last)
+    {
+        p = parse(p, last, num) + 1; // ,
+        count++;
+    }
+    return count;
+}
+
+static void run(const string &name, const string &text)
+{
+    benchReport(name + ", istringstream", benchTime([&] { benchSink += convertAll(text, oldParseNumber); }), text.size());
+    benchReport(name + ", parseJsonNumber", benchTime([&] { benchSink += convertAll(text, parseJsonNumber); }), text.size());
+    string array = "[" + text.substr(0, text.size() - 1) + "]";
+    benchReport(name + ", parseJson of an array", benchTime([&] { benchSink += parseJson(array).getJson().size(); }),
+                array.size());
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = benchScale(argc, argv, 300000);
+    cout << "bench_numbers: " << n << " numbers of each kind" << endl;
+    run("mixed", numbers(n));
+    run("coordinates", coordinates(n));
+    return 0;
+}
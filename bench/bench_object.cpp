@@ -0,0 +1,69 @@
+// object storage: the key sorted std::map against the insertion ordered JsonOrderedMap,
+// building objects, looking every key up and walking the members.
+// parseJson uses whichever of the two this program was built with, see JSON_ORDERED_OBJECT
+
+#include "bench.h"
+
+// keys like those of api responses
+static vector<string> makeKeys(size_t n)
+{
+    static const char *words[] = {"id", "name", "email", "created_at", "updated_at", "status", "type", "owner",
+                                  "description", "tags", "score", "url", "parent_id", "count", "active", "region"};
+    vector<string> keys;
+    for (size_t i = 0; i < n; i++)
+        keys.push_back(i < 16 ? words[i] : string(words[i % 16]) + "_" + to_string(i / 16));
+    return keys;
+}
+
+template <class Map>
+static void run(const char *name, const vector<string> &keys, size_t objects)
+{
+    vector<Map> maps(objects);
+    double build = benchTime([&] {
+        for (auto &m : maps)
+        {
+            m = Map();
+            for (size_t i = 0; i < keys.size(); i++)
+                m[keys[i]] = int(i);
+        }
+    });
+    double lookup = benchTime([&] {
+        size_t sum = 0;
+        for (const auto &m : maps)
+            for (const string &key : keys)
+                sum += m.find(key)->second.getInt();
+        benchSink += sum;
+    });
+    double walk = benchTime([&] {
+        size_t sum = 0;
+        for (const auto &m : maps)
+            for (const auto &member : m)
+                sum += member.first.size() + member.second.getInt();
+        benchSink += sum;
+    });
+    benchReport(string(name) + ", build", build);
+    benchReport(string(name) + ", find every key", lookup);
+    benchReport(string(name) + ", walk the members", walk);
+}
+
+int main(int argc, char **argv)
+{
+    size_t total = benchScale(argc, argv, 400000); // members over all objects
+    for (size_t n : {4, 12, 40})
+    {
+        vector<string> keys = makeKeys(n);
+        cout << "bench_object: " << total / n << " objects of " << n << " members" << endl;
+        run<map<string, Json, less<>>>("std::map", keys, total / n);
+        run<JsonOrderedMap<Json>>("JsonOrderedMap", keys, total / n);
+    }
+
+    size_t records = total / 20;
+    string text = benchRecords(records);
+#ifdef JSON_ORDERED_OBJECT
+    cout << "bench_object: parseJson with JsonOrderedMap objects" << endl;
+#else
+    cout << "bench_object: parseJson with std::map objects" << endl;
+#endif
+    benchReport("parseJson", benchTime([&] { benchSink += parseJson(text).getJson().size(); }), text.size());
+    return 0;
+}
@@ -0,0 +1,33 @@
+// one large array of records and one of numbers: parseJson against JsonParallelParser on 2 to 8 threads
+
+#include "bench.h"
+#include "../src/json_parallel.h"
+
+static void run(const string &name, const string &text)
+{
+    benchReport(name + ", parseJson", benchTime([&] { benchSink += parseJson(text).getJson().size(); }, 3), text.size());
+    for (size_t threads : {2, 4, 8})
+    {
+        JsonParallelParser parser(threads);
+        double seconds = benchTime([&] { benchSink += parser.parse(text).getJson().size(); }, 3);
+        benchReport(name + ", " + to_string(threads) + " threads", seconds, text.size());
+        cout << "    " << parser.keptChunks() << " chunks parsed on their own" << endl;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = benchScale(argc, argv, 40000);
+    string text = benchRecords(n);
+    cout << "bench_parallel: " << n << " records, " << text.size() << " bytes, " << thread::hardware_concurrency()
+         << " cores" << endl;
+
+    run("records", text);
+
+    // a plain array of numbers has no },{ to split at
+    string numbers = "[";
+    for (size_t i = 0; i < 20 * n; i++)
+        numbers += (i ? "," : "") + to_string(i * 0.25);
+    run("numbers", numbers + "]");
+    return 0;
+}
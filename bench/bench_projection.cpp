@@ -0,0 +1,49 @@
+// a few fields of wide records: parseJson and picking them out against JsonProjection
+
+#include "bench.h"
+#include "../src/json_query.h"
+
+// n records of width fields, strings, numbers and a nested array among them
+static string wideRecords(size_t n, size_t width)
+{
+    string s = "[";
+    for (size_t i = 0; i < n; i++)
+    {
+        s += i ? ",{\"id\":" : "{\"id\":";
+        s += to_string(i);
+        for (size_t f = 0; f < width; f++)
+        {
+            s += ",\"f" + to_string(f) + "\":";
+            if (f % 3 == 0)
+                s += "\"value " + to_string(i * f) + "\"";
+            else if (f % 3 == 1)
+                s += to_string(i * 0.25 + f);
+            else
+                s += "[" + to_string(f) + ",{\"x\":true}]";
+        }
+        s += "}";
+    }
+    return s + "]";
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = benchScale(argc, argv, 2000);
+    string text = wideRecords(n, 300);
+    cout << "bench_projection: " << n << " records of 300 fields, " << text.size() << " bytes" << endl;
+
+    benchReport("parseJson, then id and f150", benchTime([&] {
+                    Json all = parseJson(text).takeJson();
+                    Json part = JsonArray();
+                    for (const Json &record : all.getArray())
+                        part.push_back(JsonObject(JsonPair{"id", record["id"]}, JsonPair{"f150", record["f150"]}));
+                    benchSink += part.size();
+                }),
+                text.size());
+    JsonProjection projection({"/*/id", "/*/f150"});
+    benchReport("JsonProjection of id and f150", benchTime([&] { benchSink += projection.parse(text).getJson().size(); }),
+                text.size());
+    JsonProjection nothing({"/nope"});
+    benchReport("JsonProjection of nothing", benchTime([&] { benchSink += nothing.parse(text).isError(); }), text.size());
+    return 0;
+}
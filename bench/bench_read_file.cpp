@@ -0,0 +1,52 @@
+// loading a file for readJson: the old token by token ifstream loop against JsonFileBuffer
+
+#include "bench.h"
+
+// how readJson used to gather the input, one whitespace separated token at a time
+static string oldLoad(const string &filepath)
+{
+    string s;
+    ifstream fin(filepath);
+    while (fin)
+    {
+        string temp;
+        fin >> temp;
+        s += " " + temp;
+    }
+    return s;
+}
+
+// reads every byte, a mapped file is only loaded when touched
+static size_t touch(string_view s)
+{
+    size_t sum = 0;
+    for (char c : s)
+        sum += c;
+    return sum;
+}
+
+int main(int argc, char **argv)
+{
+    // files of 1 MB and ten times larger up to the argument, in MB. a tree takes several
+    // times the memory of its text, so files above 100 MB are only loaded, not parsed
+    size_t maxMB = benchScale(argc, argv, 100);
+    size_t recordBytes = benchRecords(1000).size() / 1000;
+    cout << "bench_read_file: files of 1 to " << maxMB << " MB" << endl;
+
+    for (size_t mb = 1; mb <= maxMB; mb *= 10)
+    {
+        BenchFile file("bench_read_file.json", benchRecords(mb * 1000000 / recordBytes));
+        size_t bytes = JsonFileBuffer(file.path()).size();
+        int repeat = mb < 100 ? 5 : 1;
+        cout << "  " << bytes << " bytes" << endl;
+        benchReport("load, token loop", benchTime([&] { benchSink += touch(oldLoad(file.path())); }, repeat), bytes);
+        benchReport("load, JsonFileBuffer",
+                    benchTime([&] { benchSink += touch(JsonFileBuffer(file.path()).view()); }, repeat), bytes);
+        if (mb > 100)
+            continue;
+        benchReport("readJson, token loop",
+                    benchTime([&] { benchSink += parseJson(oldLoad(file.path())).getJson().size(); }, repeat), bytes);
+        benchReport("readJson", benchTime([&] { benchSink += readJson(file.path()).getJson().size(); }, repeat), bytes);
+    }
+    return 0;
+}
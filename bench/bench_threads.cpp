@@ -0,0 +1,36 @@
+// parseJson on several threads at once, each parsing its own documents. the parsers share
+// no state, so documents per second should grow with the threads up to the core count
+
+#include <thread>
+#include "bench.h"
+
+int main(int argc, char **argv)
+{
+    size_t n = benchScale(argc, argv, 2000);
+    size_t cores = max(1u, thread::hardware_concurrency());
+    string text = benchRecords(50);
+    cout << "bench_threads: " << n << " documents of " << text.size() << " bytes per thread, " << cores << " cores"
+         << endl;
+
+    vector<size_t> counts = {1, 2, 4};
+    if (cores > 4)
+        counts.push_back(cores);
+    for (size_t threads : counts)
+    {
+        double seconds = benchTime([&] {
+            vector<thread> pool;
+            for (size_t t = 0; t < threads; t++)
+                pool.emplace_back([&] {
+                    size_t sum = 0;
+                    for (size_t i = 0; i < n; i++)
+                        sum += parseJson(text).getJson().size();
+                    benchSink += sum;
+                });
+            for (auto &t : pool)
+                t.join();
+        }, 3);
+        benchReport(to_string(threads) + " threads", seconds, threads * n * text.size());
+        cout << "    " << size_t(threads * n / seconds) << " documents/s" << endl;
+    }
+    return 0;
+}
@@ -15,6 +15,12 @@
 // #define JSON_SETTYPE_DEBUG
 // #define JSON_COPYVALUE_DEBUG
 // #define JSON_ACCESS_DEBUG
+// store object members in insertion order (JsonOrderedMap) instead of a key sorted map
+// #define JSON_ORDERED_OBJECT
+// share strings, arrays and objects between copies until one of them is modified
+// #define JSON_COPY_ON_WRITE
+// count payload allocations and deep copies in jsonPayloadAllocations/jsonPayloadCopies
+// #define JSON_COUNT_ALLOCATIONS
 #define TODO() cout << "TODO: " << __PRETTY_FUNCTION__ << endl
 #define INSIDE() cout << "Inside " << __PRETTY_FUNCTION__ << endl
 
@@ -24,48 +30,298 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <functional>
+#include <stdexcept>
 #include <initializer_list>
 #include <sstream>
 #include <fstream>
+#include <string_view>
+#include <charconv>
+#include <cstdint>
+#include <cfloat>
+#include <cmath>
+#if defined(JSON_COPY_ON_WRITE) || defined(JSON_COUNT_ALLOCATIONS)
+#include <atomic>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define JSON_HAS_SSE2
+#include <immintrin.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#define JSON_HAS_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 using namespace std;
 
-// convert escape characters
-string convertEscape(const string &s)
+// append the shortest text that reads back as exactly d
+inline void appendJsonDouble(string &out, double d)
 {
-    string res;
-    for (auto ch : s)
+    // json has no representation for inf and nan
+    if (!isfinite(d))
+    {
+        out += "null";
+        return;
+    }
+    char buf[32];
+    char *end = to_chars(buf, buf + sizeof(buf), d).ptr;
+    out.append(buf, end);
+    // integral values keep a fraction so they are read back as doubles
+    for (char *p = buf; p != end; p++)
+        if (*p == '.' || *p == 'e')
+            return;
+    out += ".0";
+}
+
+// append the decimal text of an integer
+template <class T>
+inline void appendJsonInteger(string &out, T n)
+{
+    char buf[24];
+    out.append(buf, to_chars(buf, buf + sizeof(buf), n).ptr);
+}
+
+// append s with its escape characters converted
+inline void appendEscaped(string &out, string_view s)
+{
+    size_t runStart = 0;
+    for (size_t i = 0; i < s.size(); i++)
     {
-        switch (ch)
+        const char *esc;
+        switch (s[i])
         {
         case '\"':
-            res += "\\\"";
+            esc = "\\\"";
             break;
         case '\\':
-            res += "\\\\";
+            esc = "\\\\";
             break;
         case '\b':
-            res += "\\b";
+            esc = "\\b";
             break;
         case '\f':
-            res += "\\f";
+            esc = "\\f";
             break;
         case '\n':
-            res += "\\n";
+            esc = "\\n";
             break;
         case '\r':
-            res += "\\r";
+            esc = "\\r";
             break;
         case '\t':
-            res += "\\t";
+            esc = "\\t";
             break;
         default:
-            res.push_back(ch);
-            break;
+            continue;
         }
+        // flush the plain characters before the escape in one go
+        out.append(s.data() + runStart, i - runStart);
+        out += esc;
+        runStart = i + 1;
     }
+    out.append(s.data() + runStart, s.size() - runStart);
+}
+
+// convert escape characters
+string convertEscape(const string &s)
+{
+    string res;
+    appendEscaped(res, s);
     return res;
 }
 
+// ========== ordered object storage
+
+// object storage keeping its members in insertion order in one contiguous vector.
+// small objects are searched linearly, bigger ones get an open addressing hash index
+template <class T>
+class JsonOrderedMap
+{
+public:
+    typedef pair<string, T> value_type;
+    typedef typename vector<value_type>::iterator iterator;
+    typedef typename vector<value_type>::const_iterator const_iterator;
+
+private:
+    static const size_t indexThreshold = 16;
+
+    vector<value_type> entries;
+    vector<uint32_t> slots; // entry index + 1, 0 for an empty slot
+
+    static size_t hashKey(string_view key) { return hash<string_view>()(key); }
+
+    void indexInsert(size_t i)
+    {
+        size_t mask = slots.size() - 1;
+        size_t slot = hashKey(entries[i].first) & mask;
+        while (slots[slot] != 0)
+            slot = (slot + 1) & mask;
+        slots[slot] = i + 1;
+    }
+
+    void rebuildIndex()
+    {
+        slots.clear();
+        if (entries.size() <= indexThreshold)
+            return;
+        size_t capacity = 64;
+        while (capacity < entries.size() * 2)
+            capacity *= 2;
+        slots.assign(capacity, 0);
+        for (size_t i = 0; i < entries.size(); i++)
+            indexInsert(i);
+    }
+
+    // position of key in entries, entries.size() if it is missing
+    size_t lookup(string_view key) const
+    {
+        if (slots.empty())
+        {
+            for (size_t i = 0; i < entries.size(); i++)
+                if (entries[i].first == key)
+                    return i;
+            return entries.size();
+        }
+        size_t mask = slots.size() - 1;
+        for (size_t slot = hashKey(key) & mask; slots[slot] != 0; slot = (slot + 1) & mask)
+            if (entries[slots[slot] - 1].first == key)
+                return slots[slot] - 1;
+        return entries.size();
+    }
+
+    iterator append(string key, T value)
+    {
+        entries.emplace_back(std::move(key), std::move(value));
+        if (entries.size() > indexThreshold)
+        {
+            if (entries.size() * 2 > slots.size())
+                rebuildIndex();
+            else
+                indexInsert(entries.size() - 1);
+        }
+        return entries.end() - 1;
+    }
+
+public:
+    JsonOrderedMap() = default;
+
+    template <class It>
+    JsonOrderedMap(It first, It last)
+    {
+        for (; first != last; ++first)
+            insert(*first);
+    }
+
+    iterator begin() { return entries.begin(); }
+    iterator end() { return entries.end(); }
+    const_iterator begin() const { return entries.begin(); }
+    const_iterator end() const { return entries.end(); }
+
+    size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+    void reserve(size_t n) { entries.reserve(n); }
+    void clear()
+    {
+        entries.clear();
+        slots.clear();
+    }
+
+    iterator find(string_view key) { return entries.begin() + lookup(key); }
+    const_iterator find(string_view key) const { return entries.begin() + lookup(key); }
+    size_t count(string_view key) const { return lookup(key) != entries.size(); }
+
+    T &at(string_view key)
+    {
+        size_t i = lookup(key);
+        if (i == entries.size())
+            throw out_of_range("JsonOrderedMap::at");
+        return entries[i].second;
+    }
+    const T &at(string_view key) const
+    {
+        size_t i = lookup(key);
+        if (i == entries.size())
+            throw out_of_range("JsonOrderedMap::at");
+        return entries[i].second;
+    }
+
+    T &operator[](string_view key)
+    {
+        size_t i = lookup(key);
+        if (i != entries.size())
+            return entries[i].second;
+        return append(string(key), T())->second;
+    }
+
+    template <class P>
+    pair<iterator, bool> insert(P &&member)
+    {
+        size_t i = lookup(member.first);
+        if (i != entries.size())
+            return {entries.begin() + i, false};
+        return {append(member.first, std::forward<P>(member).second), true};
+    }
+
+    // add key with a value built from args, unless key is already there
+    template <class... Args>
+    pair<iterator, bool> try_emplace(string key, Args &&...args)
+    {
+        size_t i = lookup(key);
+        if (i != entries.size())
+            return {entries.begin() + i, false};
+        return {append(std::move(key), T(std::forward<Args>(args)...)), true};
+    }
+
+    // erasing keeps the order of the remaining members
+    iterator erase(const_iterator pos)
+    {
+        size_t i = pos - entries.begin();
+        entries.erase(entries.begin() + i);
+        rebuildIndex();
+        return entries.begin() + i;
+    }
+    size_t erase(string_view key)
+    {
+        size_t i = lookup(key);
+        if (i == entries.size())
+            return 0;
+        erase(entries.begin() + i);
+        return 1;
+    }
+};
+
+// ========== shared payloads
+
+#ifdef JSON_COUNT_ALLOCATIONS
+// strings, arrays and objects allocated, and how many of them were deep copies
+inline atomic<size_t> jsonPayloadAllocations{0};
+inline atomic<size_t> jsonPayloadCopies{0};
+#define JSON_COUNT(counter) counter.fetch_add(1, memory_order_relaxed)
+#else
+#define JSON_COUNT(counter)
+#endif
+
+#ifdef JSON_COPY_ON_WRITE
+// a string, array or object shared by every Json copied from the same value.
+// only the reference count changes while it is shared, so readers never need a lock
+template <class T>
+struct JsonShared
+{
+    atomic<size_t> refs;
+    bool exposed = false; // a mutable reference into data was handed out, see Json::expose()
+    T data;
+
+    template <class... Args>
+    explicit JsonShared(Args &&...args) : refs(1), data(std::forward<Args>(args)...) {}
+};
+#endif
+
+class JsonWriter;
+
 class Json
 {
 public:
@@ -74,21 +330,47 @@ public:
         JT_NULL,
         JT_BOOL,
         JT_INT,
+        JT_INT64,
+        JT_UINT64,
         JT_DOUBLE,
         JT_STRING,
         JT_ARRAY,
         JT_OBJECT,
     };
 
+#ifdef JSON_ORDERED_OBJECT
+    typedef JsonOrderedMap<Json> ObjectType;
+#else
+    typedef map<string, Json, less<>> ObjectType; // less<> allows string_view lookups
+#endif
+
 private:
+    // heap storage of strings, arrays and objects
+#ifdef JSON_COPY_ON_WRITE
+    template <class T>
+    using Payload = JsonShared<T>;
+#else
+    template <class T>
+    using Payload = T;
+#endif
+
+    template <class T, class... Args>
+    static Payload<T> *newPayload(Args &&...args)
+    {
+        JSON_COUNT(jsonPayloadAllocations);
+        return new Payload<T>(std::forward<Args>(args)...);
+    }
+
     union JsonValue
     {
         bool bValue;               // boolean value
         int iValue;                // integer value
+        int64_t i64Value;          // 64-bit integer value
+        uint64_t u64Value;         // unsigned 64-bit integer value
         double dValue;             // double value
-        string *sValue;            // string value
-        vector<Json> *aValue;      // array value
-        map<string, Json> *oValue; // object value
+        Payload<string> *sValue;   // string value
+        Payload<vector<Json>> *aValue; // array value
+        Payload<ObjectType> *oValue;   // object value
     };
 
     // ========== helper functions
@@ -104,6 +386,10 @@ private:
             return "BOOL";
         case JsonType::JT_INT:
             return "INT";
+        case JsonType::JT_INT64:
+            return "INT64";
+        case JsonType::JT_UINT64:
+            return "UINT64";
         case JsonType::JT_DOUBLE:
             return "DOUBLE";
         case JsonType::JT_STRING:
@@ -116,6 +402,99 @@ private:
         return "NOT-POSSIBLE";
     }
 
+    // payload handling. with JSON_COPY_ON_WRITE a copy only shares the payload,
+    // and a payload is copied right before a shared one would be modified
+#ifdef JSON_COPY_ON_WRITE
+    template <class T>
+    static T &payload(JsonShared<T> *p) { return p->data; }
+    template <class T>
+    static JsonShared<T> *share(JsonShared<T> *p)
+    {
+        if (p->exposed)
+        {
+            JSON_COUNT(jsonPayloadCopies);
+            return newPayload<T>(p->data); // writes through old references must not reach the copy
+        }
+        p->refs.fetch_add(1, memory_order_relaxed);
+        return p;
+    }
+    template <class T>
+    static void release(JsonShared<T> *p)
+    {
+        if (p->refs.fetch_sub(1, memory_order_acq_rel) == 1)
+            delete p;
+    }
+    template <class T>
+    static void detach(JsonShared<T> *&p)
+    {
+        if (p->refs.load(memory_order_acquire) == 1)
+            return;
+        JSON_COUNT(jsonPayloadCopies);
+        JsonShared<T> *copy = newPayload<T>(p->data); // children are shared, not copied
+        release(p);
+        p = copy;
+    }
+    // once a caller holds a mutable reference into an unshared payload, later copies
+    // could not see that it is about to be written, so from then on they copy it
+    // (like the reference counted std::string of old)
+    template <class T>
+    static void expose(JsonShared<T> *p) { p->exposed = true; }
+#else
+    template <class T>
+    static T &payload(T *p) { return *p; }
+    template <class T>
+    static T *share(T *p)
+    {
+        JSON_COUNT(jsonPayloadCopies);
+        return newPayload<T>(*p);
+    }
+    template <class T>
+    static void release(T *p) { delete p; }
+    template <class T>
+    static void detach(T *&) {}
+    template <class T>
+    static void expose(T *) {}
+#endif
+
+    const string &str() const { return payload(value.sValue); }
+    string &str()
+    {
+        detach(value.sValue);
+        return payload(value.sValue);
+    }
+    const vector<Json> &arr() const { return payload(value.aValue); }
+    vector<Json> &arr()
+    {
+        detach(value.aValue);
+        return payload(value.aValue);
+    }
+    const ObjectType &obj() const { return payload(value.oValue); }
+    ObjectType &obj()
+    {
+        detach(value.oValue);
+        return payload(value.oValue);
+    }
+
+    // the same, for references that are handed out to the caller
+    string &exposedStr()
+    {
+        string &s = str();
+        expose(value.sValue);
+        return s;
+    }
+    vector<Json> &exposedArr()
+    {
+        vector<Json> &a = arr();
+        expose(value.aValue);
+        return a;
+    }
+    ObjectType &exposedObj()
+    {
+        ObjectType &o = obj();
+        expose(value.oValue);
+        return o;
+    }
+
     // deallocating the pointer values if any
     void deallocateValue()
     {
@@ -125,11 +504,11 @@ private:
 #endif
         // free the pointers
         if (isString())
-            delete value.sValue;
+            release(value.sValue);
         if (isArray())
-            delete value.aValue;
+            release(value.aValue);
         if (isObject())
-            delete value.oValue;
+            release(value.oValue);
 
         // and set type to NULL
         type = JsonType::JT_NULL;
@@ -145,6 +524,7 @@ public:
         INSIDE();
 #endif
         type = JsonType::JT_NULL;
+        value.u64Value = 0;
     }
 
     // copy constructor
@@ -159,13 +539,13 @@ public:
         switch (json.type)
         {
         case JsonType::JT_STRING:
-            value.sValue = new string(json.value.sValue->begin(), json.value.sValue->end());
+            value.sValue = share(json.value.sValue);
             break;
         case JsonType::JT_ARRAY:
-            value.aValue = new vector<Json>(json.value.aValue->begin(), json.value.aValue->end());
+            value.aValue = share(json.value.aValue);
             break;
         case JsonType::JT_OBJECT:
-            value.oValue = new map<string, Json>(json.value.oValue->begin(), json.value.oValue->end());
+            value.oValue = share(json.value.oValue);
             break;
         default:
             value = json.value;
@@ -174,7 +554,7 @@ public:
     }
 
     // move constructor
-    Json(Json &&json)
+    Json(Json &&json) noexcept
     {
 #ifdef JSON_CONSTRUCTOR_DEBUG
         INSIDE();
@@ -193,6 +573,7 @@ public:
         INSIDE();
 #endif
         type = JsonType::JT_NULL;
+        value.u64Value = 0;
     }
 
     // boolean constructor
@@ -217,6 +598,28 @@ public:
         value.iValue = n;
     }
 
+    // 64-bit integer constructor
+    Json(int64_t n)
+    {
+#ifdef JSON_CONSTRUCTOR_DEBUG
+        INSIDE();
+        cout << "set int64 value to: " << n << endl;
+#endif
+        type = JsonType::JT_INT64;
+        value.i64Value = n;
+    }
+
+    // unsigned 64-bit integer constructor
+    Json(uint64_t n)
+    {
+#ifdef JSON_CONSTRUCTOR_DEBUG
+        INSIDE();
+        cout << "set uint64 value to: " << n << endl;
+#endif
+        type = JsonType::JT_UINT64;
+        value.u64Value = n;
+    }
+
     // double constructor
     Json(double f)
     {
@@ -236,7 +639,7 @@ public:
         cout << "set string value to: " << s << endl;
 #endif
         type = JsonType::JT_STRING;
-        value.sValue = new string(s.begin(), s.end());
+        value.sValue = newPayload<string>(std::move(s));
     }
 
     // const char* constructor
@@ -247,7 +650,7 @@ public:
         cout << "set string(const char*) value to: " << s << endl;
 #endif
         type = JsonType::JT_STRING;
-        value.sValue = new string(s);
+        value.sValue = newPayload<string>(s);
     }
 
     // For Json array type
@@ -266,7 +669,7 @@ public:
         cout << endl;
 #endif
         type = JsonType::JT_ARRAY;
-        value.aValue = new vector<Json>(jsonArray.begin(), jsonArray.end());
+        value.aValue = newPayload<vector<Json>>(jsonArray.begin(), jsonArray.end());
     }
 
     // For Json object type
@@ -285,7 +688,7 @@ public:
         cout << endl;
 #endif
         type = JsonType::JT_OBJECT;
-        value.oValue = new map<string, Json>(jsonMap.begin(), jsonMap.end());
+        value.oValue = newPayload<ObjectType>(jsonMap.begin(), jsonMap.end());
     }
 
     // For array type using vector<Json>
@@ -304,7 +707,7 @@ public:
         cout << endl;
 #endif
         type = JsonType::JT_ARRAY;
-        value.aValue = new vector<Json>(jsonArray.begin(), jsonArray.end());
+        value.aValue = newPayload<vector<Json>>(std::move(jsonArray));
     }
 
     // ========== Desctructor
@@ -327,18 +730,21 @@ public:
         cout << "copy assignment type: " << printType(json.type) << endl;
         cout << "json value: " << json.dump() << endl;
 #endif
-        copyValue(json.type, json.value);
+        if (this != &json)
+            copyValue(json.type, json.value);
         return *this;
     }
 
     // move assignment
-    Json &operator=(Json &&json)
+    Json &operator=(Json &&json) noexcept
     {
 #ifdef JSON_ASSIGNMENT_DEBUG
         INSIDE();
         cout << "move assignment type: " << printType(json.type) << endl;
         cout << "json value: " << json.dump() << endl;
 #endif
+        if (this == &json)
+            return *this;
         deallocateValue();
         type = json.type;
         value = json.value;
@@ -356,9 +762,9 @@ public:
 #endif
         if (!isArray())
             throw "Error: Not an json array!";
-        if (index >= value.aValue->size())
+        if (index >= arr().size())
             throw "Error: out-of-bound error!";
-        return value.aValue->operator[](index);
+        return arr()[index];
     }
 
     Json &operator[](size_t index) // for non constant array access
@@ -368,12 +774,13 @@ public:
         cout << "index: " << index << endl;
 #endif
         setType(JsonType::JT_ARRAY);
-        if (index >= value.aValue->size())
-            value.aValue->resize(index + 1);
-        return value.aValue->operator[](index);
+        vector<Json> &elems = exposedArr();
+        if (index >= elems.size())
+            elems.resize(index + 1);
+        return elems[index];
     }
 
-    const Json &operator[](string key) const // for const object access
+    const Json &operator[](string_view key) const // for const object access, never inserts
     {
 #ifdef JSON_ACCESS_DEBUG
         INSIDE();
@@ -381,17 +788,24 @@ public:
 #endif
         if (!isObject())
             throw "Error: Not an json object!";
-        return value.oValue->operator[](key);
+        auto it = obj().find(key);
+        if (it == obj().end())
+            throw "Error: key not found!";
+        return it->second;
     }
 
-    Json &operator[](string key) // for object access
+    Json &operator[](string_view key) // for object access
     {
 #ifdef JSON_ACCESS_DEBUG
         INSIDE();
         cout << "key: " << key << endl;
 #endif
         setType(JsonType::JT_OBJECT);
-        return value.oValue->operator[](key);
+        ObjectType &members = exposedObj();
+        auto it = members.find(key); // the key is only copied when it is inserted
+        if (it != members.end())
+            return it->second;
+        return members.try_emplace(string(key)).first->second;
     }
     // ========== utility functions
 
@@ -420,17 +834,23 @@ public:
         case JsonType::JT_INT:
             value.iValue = 0;
             break;
+        case JsonType::JT_INT64:
+            value.i64Value = 0;
+            break;
+        case JsonType::JT_UINT64:
+            value.u64Value = 0;
+            break;
         case JsonType::JT_DOUBLE:
             value.dValue = 0.0;
             break;
         case JsonType::JT_STRING:
-            value.sValue = new string();
+            value.sValue = newPayload<string>();
             break;
         case JsonType::JT_ARRAY:
-            value.aValue = new vector<Json>();
+            value.aValue = newPayload<vector<Json>>();
             break;
         case JsonType::JT_OBJECT:
-            value.oValue = new map<string, Json>();
+            value.oValue = newPayload<ObjectType>();
             break;
         default:
             break;
@@ -445,54 +865,82 @@ public:
         cout << "current type: " << printType(type) << endl;
         cout << "change type: " << printType(t) << endl;
 #endif
-        deallocateValue();
-
-        type = t;
+        // copy before freeing the old value, v may be a part of it
         switch (t)
         {
-        case JsonType::JT_BOOL:
-            value.bValue = v.bValue;
-            break;
-        case JsonType::JT_INT:
-            value.iValue = v.iValue;
-            break;
-        case JsonType::JT_DOUBLE:
-            value.dValue = v.dValue;
-            break;
         case JsonType::JT_STRING:
-            value.sValue = new string(v.sValue->begin(), v.sValue->end());
+            v.sValue = share(v.sValue);
             break;
         case JsonType::JT_ARRAY:
-            value.aValue = new vector<Json>(v.aValue->begin(), v.aValue->end());
+            v.aValue = share(v.aValue);
             break;
         case JsonType::JT_OBJECT:
-            value.oValue = new map<string, Json>(v.oValue->begin(), v.oValue->end());
+            v.oValue = share(v.oValue);
             break;
         default:
             break;
         }
+        deallocateValue();
+
+        type = t;
+        value = v;
     }
 
     // at function
 
     const Json &at(size_t index) const { return operator[](index); }
     Json &at(size_t index) { return operator[](index); }
-    const Json &at(string key) const { return operator[](key); }
-    Json &at(string key) { return operator[](key); }
+    const Json &at(string_view key) const { return operator[](key); }
+    Json &at(string_view key) { return operator[](key); }
+
+    bool contains(string_view key) const { return isObject() && obj().find(key) != obj().end(); }
 
     // array functions
 
     void push_back(Json arg)
     {
         setType(JsonType::JT_ARRAY);
-        value.aValue->emplace_back(arg);
+        arr().push_back(std::move(arg));
+    }
+
+    // construct an element in place from args
+    template <class... Args>
+    Json &emplace_back(Args &&...args)
+    {
+        setType(JsonType::JT_ARRAY);
+        return exposedArr().emplace_back(std::forward<Args>(args)...);
     }
 
     void pop_back()
     {
-        if (!isArray() || value.aValue->size() == 0)
+        if (!isArray() || arr().size() == 0)
+            return;
+        arr().pop_back();
+    }
+
+    // object functions
+
+    // add key with a value built from args, unless key is already there.
+    // returns the member and whether it was added
+    template <class... Args>
+    pair<ObjectType::iterator, bool> try_emplace(string key, Args &&...args)
+    {
+        setType(JsonType::JT_OBJECT);
+        return exposedObj().try_emplace(std::move(key), std::forward<Args>(args)...);
+    }
+
+    // make room for n array elements, or n object members when the object storage supports it
+    void reserve(size_t n)
+    {
+        if (isObject())
+        {
+#ifdef JSON_ORDERED_OBJECT
+            obj().reserve(n);
+#endif
             return;
-        value.aValue->pop_back();
+        }
+        setType(JsonType::JT_ARRAY);
+        arr().reserve(n);
     }
 
     // size function
@@ -500,9 +948,9 @@ public:
     size_t size() const
     {
         if (isArray())
-            return value.aValue->size();
+            return arr().size();
         if (isObject())
-            return value.oValue->size();
+            return obj().size();
         return -1;
     }
 
@@ -511,6 +959,8 @@ public:
     bool isNull() const { return type == JsonType::JT_NULL; }
     bool isBool() const { return type == JsonType::JT_BOOL; }
     bool isInt() const { return type == JsonType::JT_INT; }
+    bool isInt64() const { return type == JsonType::JT_INT64; }
+    bool isUInt64() const { return type == JsonType::JT_UINT64; }
     bool isDouble() const { return type == JsonType::JT_DOUBLE; }
     bool isString() const { return type == JsonType::JT_STRING; }
     bool isArray() const { return type == JsonType::JT_ARRAY; }
@@ -541,6 +991,30 @@ public:
             throw "Error: not-Int!";
         return value.iValue;
     }
+    const int64_t &getInt64() const
+    {
+        if (!isInt64())
+            throw "Error: not-Int64!";
+        return value.i64Value;
+    }
+    int64_t &getInt64()
+    {
+        if (!isInt64())
+            throw "Error: not-Int64!";
+        return value.i64Value;
+    }
+    const uint64_t &getUInt64() const
+    {
+        if (!isUInt64())
+            throw "Error: not-UInt64!";
+        return value.u64Value;
+    }
+    uint64_t &getUInt64()
+    {
+        if (!isUInt64())
+            throw "Error: not-UInt64!";
+        return value.u64Value;
+    }
     const double &getDouble() const
     {
         if (!isDouble())
@@ -557,155 +1031,277 @@ public:
     {
         if (!isString())
             throw "Error: not-String!";
-        return *value.sValue;
+        return str();
     }
     string &getString()
     {
         if (!isString())
             throw "Error: not-String!";
-        return *value.sValue;
+        return exposedStr();
     }
     const vector<Json> &getArray() const
     {
         if (!isArray())
             throw "Error: not-Array!";
-        return *value.aValue;
+        return arr();
     }
     vector<Json> &getArray()
     {
         if (!isArray())
             throw "Error: not-Array!";
-        return *value.aValue;
+        return exposedArr();
     }
-    const map<string, Json> &getObject() const
+    const ObjectType &getObject() const
     {
         if (!isObject())
             throw "Error: not-Object!";
-        return *value.oValue;
+        return obj();
     }
-    map<string, Json> &getObject()
+    ObjectType &getObject()
     {
         if (!isObject())
             throw "Error: not-Object!";
-        return *value.oValue;
+        return exposedObj();
     }
 
     // printing json
 
-    string dump(int depth = 1, string tabStyle = "    ") const
-    {
-        if (isNull())
-            return "null";
-        if (isBool())
-            return (value.bValue ? "true" : "false");
-        if (isInt())
-            return to_string(value.iValue);
-        if (isDouble())
-        {
-            std::ostringstream strs;
-            strs << value.dValue;
-            return strs.str();
-        }
-        if (isString())
-            return "\"" + convertEscape(*value.sValue) + "\"";
-
-        // tab creation
-        string normalTab = "", exitTab = "";
-        for (int i = 0; i < depth; i++)
-            normalTab += tabStyle;
-        for (int i = 0; i < depth - 1; i++)
-            exitTab += tabStyle;
-
-        if (isArray())
-        {
-            if (size() == 0)
-                return "[]";
-            string res = "";
-            for (size_t i = 0; i < value.aValue->size(); i++)
-            {
-                if (i != 0)
-                    res += ",\n";
-                res += normalTab + value.aValue->at(i).dump(depth + 1);
-            }
-            return "[\n" + res + "\n" + exitTab + "]";
-        }
-
-        if (size() == 0)
-            return "{}";
-        string res = "";
-        bool skip = true;
-        for (auto p : *value.oValue)
-        {
-            if (!skip)
-                res += ",\n";
-            res += normalTab + "\"" + p.first + "\": " + p.second.dump(depth + 1);
-            skip = false;
-        }
-        return "{\n" + res + "\n" + exitTab + "}";
-    }
+    // pretty print with tabStyle indentation, or compact output when tabStyle is empty
+    string dump(int depth = 1, string tabStyle = "    ") const;
 
     // friend functions
 
     friend ostream &operator<<(ostream &out, const Json &json);
+    friend class JsonFill;
 
 private:
     JsonType type;
     JsonValue value;
 };
 
+// mutable access for the parsers and converters that fill a tree they just made.
+// unlike getString(), getArray() and getObject() the references are not exposed, so
+// copies of the finished tree still share its payloads. they must not be kept once
+// the tree is handed out
+class JsonFill
+{
+public:
+    static string &str(Json &json)
+    {
+        json.setType(Json::JsonType::JT_STRING);
+        return json.str();
+    }
+    static vector<Json> &arr(Json &json)
+    {
+        json.setType(Json::JsonType::JT_ARRAY);
+        return json.arr();
+    }
+    static Json::ObjectType &obj(Json &json)
+    {
+        json.setType(Json::JsonType::JT_OBJECT);
+        return json.obj();
+    }
+};
+
 // For Json Pair
 pair<const string, Json> operator>>(string key, Json value)
 {
-    return JsonPair{key, value};
+    return JsonPair{std::move(key), std::move(value)};
 }
 
-// print Json
-ostream &operator<<(ostream &out, const Json &json)
-{
-    out << json.dump() << endl;
-    return out;
-}
+// ========== Json writer
 
-// Json Null value
-inline Json JsonNull()
+// serializes a Json tree in a single pass, either appending into a caller owned
+// buffer (which can be cleared and reused between documents) or streaming into
+// an ostream through a fixed size internal buffer.
+// an empty tabStyle gives compact output without any whitespace.
+class JsonWriter
 {
-    return Json();
-}
+private:
+    static const size_t flushSize = 1 << 16;
 
-// Json Bool
-inline Json JsonBool(bool b)
-{
-    return Json(b);
-}
+    string own;
+    string *buf;
+    ostream *sink = nullptr;
+    string tabStyle;
+    string indent; // tabStyle repeated, grown on demand
 
-// Json Int
-inline Json JsonInt(int n)
-{
-    return Json(n);
-}
+    void newline(size_t depth)
+    {
+        if (tabStyle.empty())
+            return;
+        size_t width = depth * tabStyle.size();
+        while (indent.size() < width)
+            indent += tabStyle;
+        buf->push_back('\n');
+        buf->append(indent, 0, width);
+    }
 
-// Json double
-inline Json JsonDouble(double d)
-{
-    return Json(d);
-}
+    void writeString(const string &s)
+    {
+        buf->push_back('"');
+        appendEscaped(*buf, s);
+        buf->push_back('"');
+    }
 
-// Json string
-inline Json JsonString(string s)
-{
-    return Json(s);
-}
+public:
+    explicit JsonWriter(string &out, string tabStyle = "    ") : buf(&out), tabStyle(tabStyle) {}
+    explicit JsonWriter(ostream &out, string tabStyle = "    ") : buf(&own), sink(&out), tabStyle(tabStyle)
+    {
+        own.reserve(flushSize);
+    }
+    ~JsonWriter() { flush(); }
 
-// Json array type
-void makeArray(Json &json, const Json &arg)
-{
-    json.push_back(arg);
-}
-template <class... U>
-void makeArray(Json &json, const Json &arg1, U... args)
-{
-    json.push_back(arg1);
-    makeArray(json, args...);
+    JsonWriter(const JsonWriter &) = delete;
+    JsonWriter &operator=(const JsonWriter &) = delete;
+
+    // write json, depth is the indentation level it starts at
+    JsonWriter &write(const Json &json, size_t depth = 0)
+    {
+        switch (json.getType())
+        {
+        case Json::JsonType::JT_NULL:
+            *buf += "null";
+            break;
+        case Json::JsonType::JT_BOOL:
+            *buf += json.getBool() ? "true" : "false";
+            break;
+        case Json::JsonType::JT_INT:
+            appendJsonInteger(*buf, json.getInt());
+            break;
+        case Json::JsonType::JT_INT64:
+            appendJsonInteger(*buf, json.getInt64());
+            break;
+        case Json::JsonType::JT_UINT64:
+            appendJsonInteger(*buf, json.getUInt64());
+            break;
+        case Json::JsonType::JT_DOUBLE:
+            appendJsonDouble(*buf, json.getDouble());
+            break;
+        case Json::JsonType::JT_STRING:
+            writeString(json.getString());
+            break;
+        case Json::JsonType::JT_ARRAY:
+        {
+            const auto &arr = json.getArray();
+            if (arr.empty())
+            {
+                *buf += "[]";
+                break;
+            }
+            buf->push_back('[');
+            for (size_t i = 0; i < arr.size(); i++)
+            {
+                if (i != 0)
+                    buf->push_back(',');
+                newline(depth + 1);
+                write(arr[i], depth + 1);
+            }
+            newline(depth);
+            buf->push_back(']');
+            break;
+        }
+        case Json::JsonType::JT_OBJECT:
+        {
+            const auto &obj = json.getObject();
+            if (obj.empty())
+            {
+                *buf += "{}";
+                break;
+            }
+            buf->push_back('{');
+            bool first = true;
+            for (const auto &p : obj)
+            {
+                if (!first)
+                    buf->push_back(',');
+                first = false;
+                newline(depth + 1);
+                writeString(p.first);
+                *buf += tabStyle.empty() ? ":" : ": ";
+                write(p.second, depth + 1);
+            }
+            newline(depth);
+            buf->push_back('}');
+            break;
+        }
+        }
+        if (sink && buf->size() >= flushSize)
+            flush();
+        return *this;
+    }
+
+    // hand buffered output to the ostream, if there is one
+    void flush()
+    {
+        if (!sink || buf->empty())
+            return;
+        sink->write(buf->data(), buf->size());
+        buf->clear();
+    }
+};
+
+inline string Json::dump(int depth, string tabStyle) const
+{
+    string res;
+    JsonWriter(res, tabStyle).write(*this, depth > 0 ? depth - 1 : 0);
+    return res;
+}
+
+// print Json
+ostream &operator<<(ostream &out, const Json &json)
+{
+    JsonWriter(out).write(json);
+    out << endl;
+    return out;
+}
+
+// Json Null value
+inline Json JsonNull()
+{
+    return Json();
+}
+
+// Json Bool
+inline Json JsonBool(bool b)
+{
+    return Json(b);
+}
+
+// Json Int
+inline Json JsonInt(int n)
+{
+    return Json(n);
+}
+
+// Json 64-bit integers
+inline Json JsonInt64(int64_t n)
+{
+    return Json(n);
+}
+inline Json JsonUInt64(uint64_t n)
+{
+    return Json(n);
+}
+
+// Json double
+inline Json JsonDouble(double d)
+{
+    return Json(d);
+}
+
+// Json string
+inline Json JsonString(string s)
+{
+    return Json(std::move(s));
+}
+
+// Json array type
+template <class... T>
+void makeArray(Json &json, T &&...args)
+{
+    json.reserve(json.size() + sizeof...(args));
+    (json.push_back(std::forward<T>(args)), ...);
 }
 Json JsonArray()
 {
@@ -714,23 +1310,18 @@ Json JsonArray()
     return json;
 }
 template <class... T>
-Json JsonArray(T... args)
+Json JsonArray(T &&...args)
 {
     Json json = JsonArray();
-    makeArray(json, args...);
+    makeArray(json, std::forward<T>(args)...);
     return json;
 }
 
 // Json Object Type
-void makeObject(Json &json, const pair<const string, Json> &arg)
-{
-    json.getObject().insert(arg);
-}
-template <class... U>
-void makeObject(Json &json, const pair<const string, Json> &arg, U... args)
+template <class... T>
+void makeObject(Json &json, T &&...args)
 {
-    json.getObject().insert(arg);
-    makeObject(json, args...);
+    (json.getObject().insert(std::forward<T>(args)), ...);
 }
 Json JsonObject()
 {
@@ -739,15 +1330,385 @@ Json JsonObject()
     return json;
 }
 template <class... T>
-Json JsonObject(T... args)
+Json JsonObject(T &&...args)
 {
     Json json = JsonObject();
-    makeObject(json, args...);
+    makeObject(json, std::forward<T>(args)...);
     return json;
 }
 
+// ========== scanning
+
+// the byte runs the parsers skip over (whitespace, string contents, digits, unwanted values) are scanned
+// 16 bytes at a time with SSE2, or 32 with AVX2 when the cpu running the binary has it.
+// every scanner falls back to plain loops for the tail and on other platforms.
+
+inline bool isJsonSpace(char c) { return c == ' ' || (unsigned char)(c - '\t') <= '\r' - '\t'; }
+inline bool isJsonDigit(char c) { return (unsigned char)(c - '0') <= 9; }
+
+#ifdef JSON_HAS_SSE2
+inline bool jsonHasAvx2()
+{
+    static const bool hasAvx2 = __builtin_cpu_supports("avx2");
+    return hasAvx2;
+}
+
+// bitmasks of the bytes in a block that end a run
+
+inline unsigned sse2NotSpaceMask(const char *p)
+{
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    __m128i ctrl = _mm_sub_epi8(x, _mm_set1_epi8('\t'));
+    ctrl = _mm_cmpeq_epi8(_mm_min_epu8(ctrl, _mm_set1_epi8('\r' - '\t')), ctrl);
+    __m128i space = _mm_or_si128(ctrl, _mm_cmpeq_epi8(x, _mm_set1_epi8(' ')));
+    return ~_mm_movemask_epi8(space) & 0xFFFF;
+}
+
+inline unsigned sse2StringSpecialMask(const char *p)
+{
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    __m128i quote = _mm_cmpeq_epi8(x, _mm_set1_epi8('"'));
+    __m128i escape = _mm_cmpeq_epi8(x, _mm_set1_epi8('\\'));
+    return _mm_movemask_epi8(_mm_or_si128(quote, escape));
+}
+
+inline unsigned sse2NotDigitMask(const char *p)
+{
+    __m128i x = _mm_sub_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)), _mm_set1_epi8('0'));
+    __m128i digit = _mm_cmpeq_epi8(_mm_min_epu8(x, _mm_set1_epi8(9)), x);
+    return ~_mm_movemask_epi8(digit) & 0xFFFF;
+}
+
+// '"' and the brackets, '[' and ']' become '{' and '}' when 0x20 is set
+inline unsigned sse2BracketMask(const char *p)
+{
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    __m128i folded = _mm_or_si128(x, _mm_set1_epi8(0x20));
+    __m128i open = _mm_cmpeq_epi8(folded, _mm_set1_epi8('{'));
+    __m128i close = _mm_cmpeq_epi8(folded, _mm_set1_epi8('}'));
+    __m128i quote = _mm_cmpeq_epi8(x, _mm_set1_epi8('"'));
+    return _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(open, close), quote));
+}
+
+__attribute__((target("avx2"))) inline uint32_t avx2NotSpaceMask(const char *p)
+{
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    __m256i ctrl = _mm256_sub_epi8(x, _mm256_set1_epi8('\t'));
+    ctrl = _mm256_cmpeq_epi8(_mm256_min_epu8(ctrl, _mm256_set1_epi8('\r' - '\t')), ctrl);
+    __m256i space = _mm256_or_si256(ctrl, _mm256_cmpeq_epi8(x, _mm256_set1_epi8(' ')));
+    return ~uint32_t(_mm256_movemask_epi8(space));
+}
+
+__attribute__((target("avx2"))) inline uint32_t avx2StringSpecialMask(const char *p)
+{
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    __m256i quote = _mm256_cmpeq_epi8(x, _mm256_set1_epi8('"'));
+    __m256i escape = _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\\'));
+    return uint32_t(_mm256_movemask_epi8(_mm256_or_si256(quote, escape)));
+}
+
+__attribute__((target("avx2"))) inline uint32_t avx2NotDigitMask(const char *p)
+{
+    __m256i x = _mm256_sub_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)), _mm256_set1_epi8('0'));
+    __m256i digit = _mm256_cmpeq_epi8(_mm256_min_epu8(x, _mm256_set1_epi8(9)), x);
+    return ~uint32_t(_mm256_movemask_epi8(digit));
+}
+
+__attribute__((target("avx2"))) inline uint32_t avx2BracketMask(const char *p)
+{
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    __m256i folded = _mm256_or_si256(x, _mm256_set1_epi8(0x20));
+    __m256i open = _mm256_cmpeq_epi8(folded, _mm256_set1_epi8('{'));
+    __m256i close = _mm256_cmpeq_epi8(folded, _mm256_set1_epi8('}'));
+    __m256i quote = _mm256_cmpeq_epi8(x, _mm256_set1_epi8('"'));
+    return uint32_t(_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(open, close), quote)));
+}
+
+// advance p by whole blocks until a block has a byte in its mask
+#define JSON_SCAN_BLOCKS(width, maskFunction)        \
+    while (last - p >= width)                        \
+    {                                                \
+        uint32_t mask = maskFunction(p);             \
+        if (mask != 0)                               \
+            return p + __builtin_ctz(mask);          \
+        p += width;                                  \
+    }
+
+__attribute__((target("avx2"))) inline const char *avx2SkipWhitespace(const char *p, const char *last)
+{
+    JSON_SCAN_BLOCKS(32, avx2NotSpaceMask)
+    return p;
+}
+__attribute__((target("avx2"))) inline const char *avx2FindStringSpecial(const char *p, const char *last)
+{
+    JSON_SCAN_BLOCKS(32, avx2StringSpecialMask)
+    return p;
+}
+__attribute__((target("avx2"))) inline const char *avx2SkipDigits(const char *p, const char *last)
+{
+    JSON_SCAN_BLOCKS(32, avx2NotDigitMask)
+    return p;
+}
+__attribute__((target("avx2"))) inline const char *avx2FindBracket(const char *p, const char *last)
+{
+    JSON_SCAN_BLOCKS(32, avx2BracketMask)
+    return p;
+}
+#endif
+
+// first byte at or after p that is not whitespace
+inline const char *skipJsonWhitespace(const char *p, const char *last)
+{
+    // most runs are short, only vectorize once the first bytes are whitespace
+    if (p == last || !isJsonSpace(*p))
+        return p;
+#ifdef JSON_HAS_SSE2
+    if (last - p >= 64 && jsonHasAvx2())
+        p = avx2SkipWhitespace(p, last);
+    JSON_SCAN_BLOCKS(16, sse2NotSpaceMask)
+#endif
+    while (p != last && isJsonSpace(*p))
+        p++;
+    return p;
+}
+
+// first '"' or '\\' at or after p
+inline const char *findJsonStringSpecial(const char *p, const char *last)
+{
+#ifdef JSON_HAS_SSE2
+    if (last - p >= 64 && jsonHasAvx2())
+        p = avx2FindStringSpecial(p, last);
+    JSON_SCAN_BLOCKS(16, sse2StringSpecialMask)
+#endif
+    while (p != last && *p != '"' && *p != '\\')
+        p++;
+    return p;
+}
+
+// first '"', '[', ']', '{' or '}' at or after p
+inline const char *findJsonBracket(const char *p, const char *last)
+{
+#ifdef JSON_HAS_SSE2
+    if (last - p >= 64 && jsonHasAvx2())
+        p = avx2FindBracket(p, last);
+    JSON_SCAN_BLOCKS(16, sse2BracketMask)
+#endif
+    while (p != last && *p != '"' && *p != '[' && *p != ']' && *p != '{' && *p != '}')
+        p++;
+    return p;
+}
+
+// first byte at or after p that is not a digit
+inline const char *skipJsonDigits(const char *p, const char *last)
+{
+    // numbers are mostly short, vectorize only long digit runs
+    if (last - p < 16 || !isJsonDigit(p[0]) || !isJsonDigit(p[1]) || !isJsonDigit(p[2]) || !isJsonDigit(p[3]))
+    {
+        while (p != last && isJsonDigit(*p))
+            p++;
+        return p;
+    }
+#ifdef JSON_HAS_SSE2
+    if (last - p >= 64 && jsonHasAvx2())
+        p = avx2SkipDigits(p, last);
+    JSON_SCAN_BLOCKS(16, sse2NotDigitMask)
+#endif
+    while (p != last && isJsonDigit(*p))
+        p++;
+    return p;
+}
+
+#undef JSON_SCAN_BLOCKS
+
+// ========== number parsing
+
+// scans a number (see grammar) from [first, last) into out.
+// integers stay exact and use the smallest of int, int64 and uint64 that fits them,
+// everything else becomes the correctly rounded double.
+// returns the end of the number, or nullptr if the text is not a valid number.
+inline const char *parseJsonNumber(const char *first, const char *last, Json &out)
+{
+    static const double pow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                   1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    const char *p = first;
+    bool negative = false;
+    if (p != last && (*p == '-' || *p == '+'))
+        negative = *p++ == '-';
+
+    // integer part, accumulated while it fits into 64 bits
+    const char *digits = p;
+    p = skipJsonDigits(p, last);
+    if (p == digits)
+        return nullptr;
+    uint64_t mantissa = 0;
+    bool overflow = false;
+    for (const char *q = digits; q != p; q++)
+    {
+        unsigned d = *q - '0';
+        if (mantissa > (UINT64_MAX - d) / 10)
+            overflow = true;
+        else
+            mantissa = mantissa * 10 + d;
+    }
+
+    // plain integer
+    if (p == last || (*p != '.' && *p != 'e' && *p != 'E'))
+    {
+        if (!overflow)
+        {
+            if (negative)
+            {
+                if (mantissa <= uint64_t(INT32_MAX) + 1)
+                    out = Json(int(-int64_t(mantissa)));
+                else if (mantissa <= uint64_t(INT64_MAX) + 1)
+                    out = Json(int64_t(0 - mantissa));
+                else
+                    overflow = true;
+            }
+            else if (mantissa <= uint64_t(INT32_MAX))
+                out = Json(int(mantissa));
+            else if (mantissa <= uint64_t(INT64_MAX))
+                out = Json(int64_t(mantissa));
+            else
+                out = Json(mantissa);
+        }
+        if (!overflow)
+            return p;
+    }
+
+    // fraction
+    int exp10 = 0;
+    if (p != last && *p == '.')
+    {
+        const char *frac = ++p;
+        p = skipJsonDigits(p, last);
+        if (p == frac)
+            return nullptr;
+        for (const char *q = frac; q != p && !overflow; q++)
+        {
+            if (mantissa <= (UINT64_MAX - 9) / 10)
+            {
+                mantissa = mantissa * 10 + (*q - '0');
+                exp10--;
+            }
+            else
+                overflow = true;
+        }
+    }
+
+    // exponent
+    if (p != last && (*p == 'e' || *p == 'E'))
+    {
+        p++;
+        bool expNegative = false;
+        if (p != last && (*p == '-' || *p == '+'))
+            expNegative = *p++ == '-';
+        const char *expDigits = p;
+        int e = 0;
+        while (p != last && isJsonDigit(*p))
+        {
+            if (e < 100000)
+                e = e * 10 + (*p - '0');
+            p++;
+        }
+        if (p == expDigits)
+            return nullptr;
+        exp10 += expNegative ? -e : e;
+    }
+
+    // fast path: both the mantissa and the power of ten are exact doubles,
+    // so a single multiplication or division rounds correctly
+#if FLT_EVAL_METHOD == 0
+    if (!overflow && mantissa <= (uint64_t(1) << 53) && exp10 >= -22 && exp10 <= 22)
+    {
+        double d = double(mantissa);
+        d = exp10 < 0 ? d / pow10[-exp10] : d * pow10[exp10];
+        out = Json(negative ? -d : d);
+        return p;
+    }
+#endif
+    // slow path, from_chars does not accept a leading '+'
+    double d;
+    auto res = from_chars(negative ? first : digits, p, d);
+    if (res.ec == errc::invalid_argument || res.ptr != p)
+        return nullptr;
+    if (res.ec == errc::result_out_of_range)
+        d = exp10 < 0 ? 0.0 : HUGE_VAL;
+    out = Json(negative && res.ec != errc() ? -d : d);
+    return p;
+}
+
+// ========== string parsing
+
+// find the closing quote of a string whose contents start at p, skipping escaped characters.
+// returns last if the string is not terminated
+inline const char *scanJsonString(const char *p, const char *last)
+{
+    while (true)
+    {
+        p = findJsonStringSpecial(p, last);
+        if (p == last || *p == '"')
+            return p;
+        p += (p + 1 != last) ? 2 : 1; // '\\' and the escaped character
+    }
+}
+
+// convert the escape characters of the string contents [first, last) into out,
+// which needs room for last - first characters. returns the end of the output
+inline char *unescapeJsonString(const char *first, const char *last, char *out)
+{
+    while (first != last)
+    {
+        if (*first != '\\')
+        {
+            *out++ = *first++;
+            continue;
+        }
+        if (++first == last) // lone '\' at the end
+        {
+            *out++ = '\\';
+            break;
+        }
+        switch (*first)
+        {
+        case '"':
+            *out++ = '"';
+            break;
+        case '\\':
+            *out++ = '\\';
+            break;
+        case 't':
+            *out++ = '\t';
+            break;
+        case 'n':
+            *out++ = '\n';
+            break;
+        case 'f':
+            *out++ = '\f';
+            break;
+        case 'b':
+            *out++ = '\b';
+            break;
+        case 'r':
+            *out++ = '\r';
+            break;
+        // TODO: for any hex escape character
+        // case 'u':
+        //    TODO();
+        default: // for invalid escape character
+            *out++ = '\\';
+            *out++ = *first;
+            break;
+        }
+        first++;
+    }
+    return out;
+}
+
 // Json parsing
 
+// either a parsed Json or an error message. the Json is moved in and out, never copied
+// unless asked for, e.g. Json json = readJson(path).getJson() moves the whole tree
 class ParseResult
 {
 private:
@@ -756,33 +1717,94 @@ private:
     string err;
 
 public:
-    bool isError() { return is_err; }
-    ParseResult setError(string e)
+    bool isError() const { return is_err; }
+    explicit operator bool() const { return !is_err; }
+
+    ParseResult &setError(string e) &
     {
         is_err = true;
-        err = e;
+        err = std::move(e);
+        return *this;
+    }
+    ParseResult &&setError(string e) &&
+    {
+        return std::move(setError(std::move(e)));
+    }
+    ParseResult &setJson(Json &&r) &
+    {
+        res = std::move(r);
         return *this;
     }
-    ParseResult setJson(Json r)
+    ParseResult &&setJson(Json &&r) &&
+    {
+        return std::move(setJson(std::move(r)));
+    }
+    ParseResult &setJson(const Json &r) &
     {
         res = r;
         return *this;
     }
+    ParseResult &&setJson(const Json &r) &&
+    {
+        return std::move(setJson(r));
+    }
     string getError() const
     {
         return err;
     }
-    Json getJson() const
+    const Json &getJson() const &
+    {
+        return res;
+    }
+    Json &getJson() &
     {
         return res;
     }
+    Json getJson() &&
+    {
+        return std::move(res);
+    }
+    // move the Json out, leaving null behind
+    Json takeJson()
+    {
+        return std::move(res);
+    }
+};
+
+// ========== event parsing
+
+// base for the handlers of JsonEventParser. every event returns whether parsing should go on,
+// handlers derive from it and only redefine the events they need.
+// the string_view of onString and onKey is only valid during the call
+struct JsonHandler
+{
+    bool onNull() { return true; }
+    bool onBool(bool) { return true; }
+    bool onNumber(const Json &) { return true; } // an int, int64, uint64 or double Json
+    bool onString(string_view) { return true; }
+    bool onStartArray() { return true; }
+    bool onEndArray() { return true; }
+    bool onStartObject() { return true; }
+    bool onKey(string_view) { return true; }
+    bool onEndObject() { return true; }
+    // asked before every array element and member value. a value that is not wanted is
+    // skipped without being reported; inside a skipped array or object only the strings
+    // and the bracket nesting are checked
+    bool wantValue() { return true; }
 };
 
-struct
+// recursive descent tokenizer that reports what it reads to a handler instead of building a tree.
+// apart from the recursion it only keeps one scratch buffer for strings that contain escapes
+template <class Handler>
+class JsonEventParser
 {
 private:
-    string src;
-    int curIndex;
+    string_view src;
+    size_t curIndex;
+    Handler *handler;
+    string scratch;
+    string err;
+    bool stopped;
 
     bool isEnd(size_t offset = 0)
     {
@@ -807,230 +1829,478 @@ private:
 
     void ignoreWhitespace()
     {
-        while (!isEnd() && isspace(peek()))
-            advance();
+        curIndex = skipJsonWhitespace(src.data() + curIndex, src.data() + src.size()) - src.data();
     }
 
-    template <class T>
-    ParseResult parseConstant(string name, T value)
+    bool fail(string e)
+    {
+        err = e;
+        return false;
+    }
+
+    // the result of an event
+    bool event(bool keepGoing)
+    {
+        if (keepGoing)
+            return true;
+        stopped = true;
+        return fail("Stopped by the handler.");
+    }
+
+    // whether the constant name is at the current position, and jump over it
+    bool skipConstant(string_view name)
     {
-        if (src.substr(curIndex, name.size()) != name ||
+        if (src.compare(curIndex, name.size(), name) != 0 ||
             (!isEnd(name.size()) && (isalnum(peek(name.size())) || peek(name.size()) == '_')))
-            return ParseResult().setError("Unexpected Constant.");
+            return fail("Unexpected Constant.");
         advance(name.size());
-        return ParseResult().setJson(value);
+        return true;
     }
 
-    ParseResult parseString()
+    // jump over a value without reporting it. numbers, constants and strings are checked
+    // as when parsed; inside an array or object only strings and bracket nesting are
+    bool skipValue()
     {
-        advance(); // "
-        string val;
-        while (!isEnd() && peek() != '"')
+        ignoreWhitespace();
+        const char *p = src.data() + curIndex, *last = src.data() + src.size();
+        if (p == last)
+            return fail("Undefined token '" + string(1, '\0') + "'.");
+        if (*p == '"')
         {
-            if (peek() == '\\') // for escape characters
+            p = scanJsonString(p + 1, last);
+            if (p == last)
+                return fail("Expected '\"'.");
+            curIndex = p + 1 - src.data();
+            return true;
+        }
+        if (*p == 'n')
+            return skipConstant("null");
+        if (*p == 't')
+            return skipConstant("true");
+        if (*p == 'f')
+            return skipConstant("false");
+        if (*p == '+' || *p == '-' || isdigit(*p))
+        {
+            Json num;
+            const char *end = parseJsonNumber(p, last, num);
+            if (end == nullptr)
+                return fail("Invalid number.");
+            curIndex = end - src.data();
+            return true;
+        }
+        if (*p != '[' && *p != '{')
+            return fail("Undefined token '" + string(1, *p) + "'.");
+
+        // one bit per open bracket, set for '{'
+        const size_t maxDepth = 4096;
+        uint64_t objects[maxDepth / 64];
+        size_t depth = 0;
+        for (; (p = findJsonBracket(p, last)) != last; p++)
+        {
+            if (*p == '"')
+            {
+                p = scanJsonString(p + 1, last);
+                if (p == last)
+                    break;
+            }
+            else if (*p == '[' || *p == '{')
             {
-                advance(); // '\'
-                if (peek() == '"')
-                    val += "\"";
-                else if (peek() == '\\')
-                    val += "\\";
-                else if (peek() == 't')
-                    val += "\t";
-                else if (peek() == 'n')
-                    val += "\n";
-                else if (peek() == 'f')
-                    val += "\f";
-                else if (peek() == 'b')
-                    val += "\b";
-                else if (peek() == 'r')
-                    val += "\r";
-                // TODO: for any hex escape character
-                // else if (peek() == 'u')
-                // {
-                //    TODO();
-                // }
-                else // for invalid escape character
-                    val += "\\" + string(1, peek());
-                advance();
+                if (depth == maxDepth)
+                    return fail("Too deeply nested value.");
+                uint64_t bit = uint64_t(1) << (depth % 64);
+                if (*p == '{')
+                    objects[depth / 64] |= bit;
+                else
+                    objects[depth / 64] &= ~bit;
+                depth++;
             }
             else
-                val += advance();
+            {
+                depth--;
+                bool object = objects[depth / 64] >> (depth % 64) & 1;
+                if (object != (*p == '}'))
+                    return fail(object ? "Expected '}'." : "Expected ']'.");
+                if (depth == 0)
+                {
+                    curIndex = p + 1 - src.data();
+                    return true;
+                }
+            }
         }
-        advance(); // "
-        return ParseResult().setJson(val);
+        depth--; // the innermost bracket left open
+        return fail(objects[depth / 64] >> (depth % 64) & 1 ? "Expected '}'." : "Expected ']'.");
     }
 
-    ParseResult parseNumber()
+    // the next array element or member value, or skip it if the handler does not want it
+    bool parseMember()
     {
-        int startIndex = curIndex;
-        advance(); // - or + or some digit
-        bool isInt = true;
-        // check for integer
-        while (!isEnd() && isdigit(peek()))
-            advance();
+        return handler->wantValue() ? parseValue() : skipValue();
+    }
 
-        // check if fraction
-        if (peek() == '.')
-        {
-            isInt = false;
-            advance(); // '.'
-            while (!isEnd() && isdigit(peek()))
-                advance();
-        }
+    bool parseConstant(string_view name)
+    {
+        if (!skipConstant(name))
+            return false;
+        if (name[0] == 'n')
+            return event(handler->onNull());
+        return event(handler->onBool(name[0] == 't'));
+    }
 
-        // check for exponents
-        if (peek() == 'e' || peek() == 'E')
+    bool parseString(bool isKey)
+    {
+        advance(); // "
+        const char *first = src.data() + curIndex;
+        const char *last = src.data() + src.size();
+        const char *special = findJsonStringSpecial(first, last);
+        string_view val;
+        if (special == last)
+            return fail("Expected '\"'.");
+        if (*special == '"') // no escapes, hand out the input itself
         {
-            isInt = false;
-            advance(); // e
-            while (!isEnd() && isdigit(peek()))
-                advance();
+            val = string_view(first, special - first);
+            curIndex = special - src.data();
         }
-
-        std::istringstream sin(src.substr(startIndex, curIndex - startIndex));
-        if (isInt)
+        else
         {
-            int d;
-            sin >> d;
-            return ParseResult().setJson(d);
+            const char *close = scanJsonString(special, last);
+            if (close == last)
+                return fail("Expected '\"'.");
+            scratch.resize(close - first);
+            val = string_view(scratch.data(), unescapeJsonString(first, close, &scratch[0]) - scratch.data());
+            curIndex = close - src.data();
         }
-        double d;
-        sin >> d;
-        return ParseResult().setJson(d);
+        advance(); // "
+        return event(isKey ? handler->onKey(val) : handler->onString(val));
+    }
+
+    bool parseNumber()
+    {
+        Json num;
+        const char *end = parseJsonNumber(src.data() + curIndex, src.data() + src.size(), num);
+        if (end == nullptr)
+            return fail("Invalid number.");
+        curIndex = end - src.data();
+        return event(handler->onNumber(num));
     }
 
-    ParseResult parseArray()
+    bool parseArray()
     {
         advance(); // [
+        if (!event(handler->onStartArray()))
+            return false;
         ignoreWhitespace();
-        vector<Json> val;
-        if (peek() == ']')
+        while (!isEnd() && peek() != ']')
         {
-            advance(); // ]
-            return ParseResult().setJson(JsonArray());
-        }
-        auto elem = parseValue();
-        if (elem.isError())
-            return elem;
-        val.push_back(elem.getJson());
-        ignoreWhitespace();
-        while (!isEnd() && peek() == ',')
-        {
-            advance(); // ,
+            if (!parseMember())
+                return false;
             ignoreWhitespace();
-            if (peek() == ']')
-            {
-                advance(); // ]
-                return ParseResult().setJson(val);
-            }
-            elem = parseValue();
-            if (elem.isError())
-                return elem;
-            val.push_back(elem.getJson());
+            if (peek() != ',')
+                break;
+            advance(); // ,
             ignoreWhitespace();
         }
         if (peek() != ']')
-            return ParseResult().setError("Expected ']'.");
+            return fail("Expected ']'.");
         advance(); // ]
-        return ParseResult().setJson(val);
+        return event(handler->onEndArray());
     }
 
-    ParseResult parseObject()
+    bool parseObject()
     {
         advance(); // {
+        if (!event(handler->onStartObject()))
+            return false;
         ignoreWhitespace();
-        if (peek() == '}')
+        while (!isEnd() && peek() != '}')
         {
-            advance(); // }
-            return ParseResult().setJson(JsonObject());
-        }
-        Json obj;
-        auto key = parseString(); // key
-        if (key.isError())
-            return key;
-        ignoreWhitespace();
-        advance(); // ':'
-        ignoreWhitespace();
-        auto value = parseValue(); // value
-        if (value.isError())
-            return value;
-        obj[key.getJson().getString()] = value.getJson();
-        ignoreWhitespace();
-        while (!isEnd() && peek() == ',')
-        {
-            advance(); // ,
-            ignoreWhitespace();
-            if (peek() == '}')
-            {
-                advance(); // }
-                return ParseResult().setJson(obj);
-            }
-            auto key = parseString(); // key
-            if (key.isError())
-                return key;
+            if (peek() != '"')
+                return fail("Expected '\"'.");
+            if (!parseString(true)) // key
+                return false;
             ignoreWhitespace();
+            if (peek() != ':')
+                return fail("Expected ':'.");
             advance(); // ':'
+            if (!parseMember()) // value
+                return false;
             ignoreWhitespace();
-            auto value = parseValue(); // value
-            if (value.isError())
-                return value;
-            obj[key.getJson().getString()] = value.getJson();
+            if (peek() != ',')
+                break;
+            advance(); // ,
             ignoreWhitespace();
         }
         if (peek() != '}')
-            return ParseResult().setError("Expected ']'.");
+            return fail("Expected '}'.");
         advance(); // }
-        return ParseResult().setJson(obj);
+        return event(handler->onEndObject());
     }
 
-    ParseResult parseValue()
+    bool parseValue()
     {
         ignoreWhitespace();
         if (peek() == 'n')
-            return parseConstant("null", nullptr);
+            return parseConstant("null");
         if (peek() == 't')
-            return parseConstant("true", true);
+            return parseConstant("true");
         if (peek() == 'f')
-            return parseConstant("false", false);
+            return parseConstant("false");
         if (peek() == '+' || peek() == '-' || isdigit(peek()))
             return parseNumber();
         if (peek() == '"')
-            return parseString();
+            return parseString(false);
         if (peek() == '[')
             return parseArray();
         if (peek() == '{')
             return parseObject();
-        return ParseResult().setError("Undefined token '" + string(1, peek()) + "'.");
+        return fail("Undefined token '" + string(1, peek()) + "'.");
     }
 
 public:
-    ParseResult operator()(const string &s)
+    // parse s, reporting every value to h.
+    // returns false on invalid input or when the handler asked to stop
+    bool parse(string_view s, Handler &h)
     {
         src = s;
         curIndex = 0;
+        handler = &h;
+        err.clear();
+        stopped = false;
 
-        ParseResult res = parseValue();
-        if (res.isError())
-            return res;
-        ignoreWhitespace();
-        if (!isEnd())
-            return res.setError("Something went wrong!");
-        return res;
+        bool ok = parseValue();
+        if (ok)
+        {
+            ignoreWhitespace();
+            if (!isEnd())
+                ok = fail("Something went wrong!");
+        }
+        src = string_view();
+        return ok;
+    }
+
+    // parse only the value at the start of s, whatever follows it is left alone.
+    // returns the length read including leading whitespace, 0 on error
+    size_t parsePrefix(string_view s, Handler &h)
+    {
+        src = s;
+        curIndex = 0;
+        handler = &h;
+        err.clear();
+        stopped = false;
+
+        size_t n = parseValue() ? curIndex : 0;
+        src = string_view();
+        return n;
+    }
+
+    string getError() const { return err; }
+    // parse() returned false because the handler stopped it, not because of an error
+    bool wasStopped() const { return stopped; }
+};
+
+// handler building a Json tree. every value is constructed in its final place
+// in the tree, the stack only points at the containers that are still open
+class JsonDomBuilder : public JsonHandler
+{
+private:
+    Json root;
+    vector<Json *> stack;
+    string key;
+
+    // the place for the next value
+    Json &slot()
+    {
+        if (stack.empty())
+            return root;
+        Json &top = *stack.back();
+        if (top.isArray())
+            return JsonFill::arr(top).emplace_back();
+        return JsonFill::obj(top)[key];
     }
-} parseJson;
+
+public:
+    bool onNull()
+    {
+        slot() = Json();
+        return true;
+    }
+    bool onBool(bool b)
+    {
+        slot() = Json(b);
+        return true;
+    }
+    bool onNumber(const Json &number)
+    {
+        slot() = number;
+        return true;
+    }
+    bool onString(string_view s)
+    {
+        JsonFill::str(slot()).assign(s.data(), s.size());
+        return true;
+    }
+    bool onStartArray()
+    {
+        Json &arr = slot();
+        arr = JsonArray(); // a repeated key starts over
+        stack.push_back(&arr);
+        return true;
+    }
+    bool onEndArray()
+    {
+        stack.pop_back();
+        return true;
+    }
+    bool onStartObject()
+    {
+        Json &obj = slot();
+        obj = JsonObject();
+        stack.push_back(&obj);
+        return true;
+    }
+    bool onKey(string_view k)
+    {
+        key.assign(k.data(), k.size());
+        return true;
+    }
+    bool onEndObject()
+    {
+        stack.pop_back();
+        return true;
+    }
+
+    Json &getJson() { return root; }
+
+    // start over for the next document
+    void reset()
+    {
+        root = Json();
+        stack.clear();
+    }
+};
+
+// parser producing Json trees. it holds no state between documents except buffers,
+// so one instance can be reused without reallocating them, and separate instances
+// can be used on separate threads at the same time
+class JsonParser
+{
+private:
+    JsonDomBuilder builder;
+    JsonEventParser<JsonDomBuilder> parser;
+
+public:
+    ParseResult parse(string_view s)
+    {
+        builder.reset();
+        if (!parser.parse(s, builder))
+            return ParseResult().setError(parser.getError());
+        return ParseResult().setJson(std::move(builder.getJson()));
+    }
+
+    ParseResult operator()(string_view s) { return parse(s); }
+};
+
+// parse a Json tree from s. every call has its own parser state, so this is safe
+// to call from several threads at once
+inline ParseResult parseJson(string_view s)
+{
+    JsonParser parser;
+    return parser.parse(s);
+}
+
+// read-only contents of a whole file, memory-mapped when the platform allows it,
+// otherwise loaded with a single sized read. a mapping is read ahead aggressively
+// unless sequential is false, for files that are looked up in random order
+class JsonFileBuffer
+{
+private:
+    const char *ptr = nullptr;
+    size_t len = 0;
+    bool opened = false;
+    bool mapped = false;
+    string fallback;
+
+    bool readAll(const string &filepath)
+    {
+        ifstream fin(filepath, ios::binary);
+        if (!fin.good())
+            return false;
+        fin.seekg(0, ios::end);
+        streamsize n = fin.tellg();
+        if (n >= 0)
+        {
+            fallback.resize(n);
+            fin.seekg(0);
+            if (n > 0 && !fin.read(&fallback[0], n))
+                return false;
+        }
+        else
+        {
+            // pipes cannot seek, read them in chunks until the end
+            fin.clear();
+            char chunk[1 << 16];
+            while (fin.read(chunk, sizeof(chunk)) || fin.gcount() > 0)
+                fallback.append(chunk, fin.gcount());
+            if (fin.bad())
+                return false;
+        }
+        ptr = fallback.data();
+        len = fallback.size();
+        return true;
+    }
+
+public:
+    explicit JsonFileBuffer(const string &filepath, bool sequential = true)
+    {
+#ifdef JSON_HAS_MMAP
+        int fd = ::open(filepath.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+        {
+            void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED)
+            {
+                madvise(p, st.st_size, sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+                ptr = static_cast<const char *>(p);
+                len = st.st_size;
+                mapped = true;
+            }
+        }
+        ::close(fd);
+        if (mapped)
+        {
+            opened = true;
+            return;
+        }
+#endif
+        // empty files, pipes, or no mmap support
+        opened = readAll(filepath);
+    }
+
+    ~JsonFileBuffer()
+    {
+#ifdef JSON_HAS_MMAP
+        if (mapped)
+            munmap(const_cast<char *>(ptr), len);
+#endif
+    }
+
+    JsonFileBuffer(const JsonFileBuffer &) = delete;
+    JsonFileBuffer &operator=(const JsonFileBuffer &) = delete;
+
+    bool isOpen() const { return opened; }
+    const char *data() const { return ptr; }
+    size_t size() const { return len; }
+    string_view view() const { return string_view(ptr, len); }
+};
 
 ParseResult readJson(string filepath)
 {
-    string s;
-    ifstream fin(filepath);
-    if (!fin.good())
+    JsonFileBuffer file(filepath);
+    if (!file.isOpen())
         return ParseResult().setError("file " + filepath + " not found!");
-    while (fin) {
-        string temp;
-        fin >> temp;
-        s += " " + temp;
-    }
-    return parseJson(s);
+    return parseJson(file.view());
 }
 
 #endif // JSON_H
\ No newline at end of file
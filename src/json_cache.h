@@ -0,0 +1,214 @@
+/*
+    cache of parsed json files.
+
+    a JsonCache keeps the trees of the files read through it, and hands out the same
+    immutable tree again for as long as the file keeps its size and modification time.
+    the least recently used trees are dropped once their estimated memory passes the cap;
+    trees handed out stay valid for as long as someone holds them.
+
+    static JsonCache cache(64 << 20);
+    string err;
+    shared_ptr<const Json> conf = cache.read("config.json", &err);
+    if (!conf)
+        cout << err << endl;
+*/
+
+#ifndef JSON_CACHE_H
+#define JSON_CACHE_H
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <filesystem>
+#include "json.h"
+
+class JsonCache
+{
+public:
+    struct Stats
+    {
+        size_t hits = 0;
+        size_t misses = 0;    // files that had to be parsed
+        size_t evictions = 0; // trees dropped to stay under the cap
+        size_t entries = 0;
+        size_t bytes = 0; // estimated memory of the cached trees
+    };
+
+private:
+    // what identifies a version of a file
+    struct Stamp
+    {
+        uintmax_t size;
+        filesystem::file_time_type mtime;
+
+        bool operator==(const Stamp &other) const { return size == other.size && mtime == other.mtime; }
+    };
+
+    struct Entry
+    {
+        Stamp stamp;
+        shared_ptr<const Json> json;
+        size_t bytes;
+        list<string>::iterator lru;
+    };
+
+    mutable mutex lock;
+    size_t maxBytes;
+    unordered_map<string, Entry> entries;
+    list<string> lru; // paths, most recently used first
+    Stats stats;
+
+    static bool stampOf(const string &filepath, Stamp &stamp)
+    {
+        error_code ec;
+        stamp.size = filesystem::file_size(filepath, ec);
+        if (ec)
+            return false;
+        stamp.mtime = filesystem::last_write_time(filepath, ec);
+        return !ec;
+    }
+
+    // rough heap footprint of a tree, enough to weigh trees against each other
+    static size_t estimateBytes(const Json &json)
+    {
+        switch (json.getType())
+        {
+        case Json::JsonType::JT_STRING:
+            return sizeof(Json) + sizeof(string) + json.getString().capacity();
+        case Json::JsonType::JT_ARRAY:
+        {
+            const auto &arr = json.getArray();
+            size_t n = sizeof(Json) + sizeof(vector<Json>) + (arr.capacity() - arr.size()) * sizeof(Json);
+            for (const auto &elem : arr)
+                n += estimateBytes(elem);
+            return n;
+        }
+        case Json::JsonType::JT_OBJECT:
+        {
+            size_t n = sizeof(Json) + sizeof(Json::ObjectType);
+            for (const auto &p : json.getObject())
+                n += 4 * sizeof(void *) + sizeof(string) + p.first.capacity() + estimateBytes(p.second);
+            return n;
+        }
+        default:
+            return sizeof(Json);
+        }
+    }
+
+    void erase(unordered_map<string, Entry>::iterator it)
+    {
+        stats.bytes -= it->second.bytes;
+        lru.erase(it->second.lru);
+        entries.erase(it);
+    }
+
+    // drop the least recently used trees until the cache fits its cap
+    void shrink()
+    {
+        while (stats.bytes > maxBytes && !lru.empty())
+        {
+            erase(entries.find(lru.back()));
+            stats.evictions++;
+        }
+    }
+
+public:
+    // maxBytes caps the estimated memory of the cached trees
+    explicit JsonCache(size_t maxBytes = size_t(256) << 20) : maxBytes(maxBytes) {}
+
+    JsonCache(const JsonCache &) = delete;
+    JsonCache &operator=(const JsonCache &) = delete;
+
+    // the tree of filepath, parsed again only if the file changed since it was cached.
+    // returns nullptr and sets err if the file cannot be read or is not valid json
+    shared_ptr<const Json> read(const string &filepath, string *err = nullptr)
+    {
+        Stamp stamp;
+        bool found = stampOf(filepath, stamp);
+        {
+            lock_guard<mutex> guard(lock);
+            auto it = entries.find(filepath);
+            if (it != entries.end())
+            {
+                if (found && it->second.stamp == stamp)
+                {
+                    stats.hits++;
+                    lru.splice(lru.begin(), lru, it->second.lru);
+                    return it->second.json;
+                }
+                erase(it); // changed or gone
+            }
+            stats.misses++;
+        }
+        if (!found)
+        {
+            if (err)
+                *err = "file " + filepath + " not found!";
+            return nullptr;
+        }
+
+        // parse without holding the lock, other files stay available meanwhile
+        ParseResult res = readJson(filepath);
+        if (res.isError())
+        {
+            if (err)
+                *err = res.getError();
+            return nullptr;
+        }
+        auto json = make_shared<const Json>(res.takeJson());
+        size_t bytes = estimateBytes(*json);
+
+        lock_guard<mutex> guard(lock);
+        auto it = entries.find(filepath);
+        if (it != entries.end())
+        {
+            if (it->second.stamp == stamp)
+                return it->second.json; // another thread read the same version meanwhile
+            erase(it);
+        }
+        if (bytes > maxBytes)
+            return json; // would evict everything else, hand it out uncached
+        lru.push_front(filepath);
+        entries.emplace(filepath, Entry{stamp, json, bytes, lru.begin()});
+        stats.bytes += bytes;
+        shrink();
+        return json;
+    }
+
+    // forget filepath, returns whether it was cached
+    bool erase(const string &filepath)
+    {
+        lock_guard<mutex> guard(lock);
+        auto it = entries.find(filepath);
+        if (it == entries.end())
+            return false;
+        erase(it);
+        return true;
+    }
+
+    void clear()
+    {
+        lock_guard<mutex> guard(lock);
+        entries.clear();
+        lru.clear();
+        stats.bytes = 0;
+    }
+
+    void setMaxBytes(size_t n)
+    {
+        lock_guard<mutex> guard(lock);
+        maxBytes = n;
+        shrink();
+    }
+
+    Stats getStats() const
+    {
+        lock_guard<mutex> guard(lock);
+        Stats res = stats;
+        res.entries = entries.size();
+        return res;
+    }
+};
+
+#endif // JSON_CACHE_H
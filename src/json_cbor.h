@@ -0,0 +1,502 @@
+/*
+    cbor (rfc 8949) encoding of Json trees.
+
+    containers are written with their length up front, so the decoder can size arrays
+    before filling them, and numbers and strings are copied as they are instead of being
+    formatted and parsed again. integers are read back as the smallest of int, int64 and
+    uint64 that fits them, as parseJson does, and doubles that are exact as floats take
+    4 bytes instead of 8.
+
+    string bin = dumpCbor(json);
+    ParseResult res = parseCbor(bin);
+
+    CborWriter writes documents piece by piece without building a Json first:
+
+    CborWriter out(cout);
+    out.beginObject(2).writeKey("id").writeInt(7).writeKey("tags").beginArray();
+    for (auto &tag : tags)
+        out.writeString(tag);
+    out.end(); // only containers started without a length need end()
+*/
+
+#ifndef JSON_CBOR_H
+#define JSON_CBOR_H
+
+#include <cstring>
+#include <cfloat>
+#include <cmath>
+#include "json.h"
+
+// ========== cbor writer
+
+// like JsonWriter it appends into a caller owned buffer or streams into an ostream
+// through a fixed size internal buffer
+class CborWriter
+{
+public:
+    // length of a container whose size is not known when it is started
+    static const size_t unknownSize = size_t(-1);
+
+private:
+    static const size_t flushSize = 1 << 16;
+
+    string own;
+    string *buf;
+    ostream *sink = nullptr;
+
+    // initial byte of major type major followed by the shortest encoding of n
+    void head(uint8_t major, uint64_t n)
+    {
+        major <<= 5;
+        if (n < 24)
+            buf->push_back(char(major | n));
+        else if (n <= 0xff)
+        {
+            buf->push_back(char(major | 24));
+            buf->push_back(char(n));
+        }
+        else if (n <= 0xffff)
+        {
+            buf->push_back(char(major | 25));
+            bigEndian(n, 2);
+        }
+        else if (n <= 0xffffffff)
+        {
+            buf->push_back(char(major | 26));
+            bigEndian(n, 4);
+        }
+        else
+        {
+            buf->push_back(char(major | 27));
+            bigEndian(n, 8);
+        }
+    }
+
+    void bigEndian(uint64_t n, int bytes)
+    {
+        char b[8];
+        for (int i = bytes - 1; i >= 0; i--, n >>= 8)
+            b[i] = char(n);
+        buf->append(b, bytes);
+    }
+
+    CborWriter &done()
+    {
+        if (sink && buf->size() >= flushSize)
+            flush();
+        return *this;
+    }
+
+public:
+    explicit CborWriter(string &out) : buf(&out) {}
+    explicit CborWriter(ostream &out) : buf(&own), sink(&out) { own.reserve(flushSize); }
+    ~CborWriter() { flush(); }
+
+    CborWriter(const CborWriter &) = delete;
+    CborWriter &operator=(const CborWriter &) = delete;
+
+    CborWriter &write(const Json &json)
+    {
+        switch (json.getType())
+        {
+        case Json::JsonType::JT_NULL:
+            return writeNull();
+        case Json::JsonType::JT_BOOL:
+            return writeBool(json.getBool());
+        case Json::JsonType::JT_INT:
+            return writeInt(json.getInt());
+        case Json::JsonType::JT_INT64:
+            return writeInt(json.getInt64());
+        case Json::JsonType::JT_UINT64:
+            return writeUInt(json.getUInt64());
+        case Json::JsonType::JT_DOUBLE:
+            return writeDouble(json.getDouble());
+        case Json::JsonType::JT_STRING:
+            return writeString(json.getString());
+        case Json::JsonType::JT_ARRAY:
+            beginArray(json.getArray().size());
+            for (const auto &elem : json.getArray())
+                write(elem);
+            return done();
+        case Json::JsonType::JT_OBJECT:
+            beginObject(json.getObject().size());
+            for (const auto &p : json.getObject())
+            {
+                writeKey(p.first);
+                write(p.second);
+            }
+            return done();
+        }
+        return *this;
+    }
+
+    CborWriter &writeNull()
+    {
+        buf->push_back(char(0xf6));
+        return done();
+    }
+
+    CborWriter &writeBool(bool b)
+    {
+        buf->push_back(char(b ? 0xf5 : 0xf4));
+        return done();
+    }
+
+    CborWriter &writeInt(int64_t n)
+    {
+        if (n >= 0)
+            head(0, uint64_t(n));
+        else
+            head(1, uint64_t(-(n + 1)));
+        return done();
+    }
+
+    CborWriter &writeUInt(uint64_t n)
+    {
+        head(0, n);
+        return done();
+    }
+
+    // 4 bytes when the value survives the round trip through float, 8 otherwise.
+    // finite values beyond the float range cannot be narrowed at all
+    CborWriter &writeDouble(double d)
+    {
+        bool narrows = !isfinite(d) || fabs(d) <= FLT_MAX;
+        float f = narrows ? float(d) : 0.0f;
+        if (narrows && (double(f) == d || isnan(d)))
+        {
+            uint32_t bits;
+            memcpy(&bits, &f, sizeof(bits));
+            buf->push_back(char(0xfa));
+            bigEndian(bits, 4);
+        }
+        else
+        {
+            uint64_t bits;
+            memcpy(&bits, &d, sizeof(bits));
+            buf->push_back(char(0xfb));
+            bigEndian(bits, 8);
+        }
+        return done();
+    }
+
+    CborWriter &writeString(string_view s)
+    {
+        head(3, s.size());
+        buf->append(s.data(), s.size());
+        return done();
+    }
+
+    CborWriter &writeKey(string_view key) { return writeString(key); }
+
+    // start an array of n elements, or of elements up to a matching end()
+    CborWriter &beginArray(size_t n = unknownSize)
+    {
+        if (n == unknownSize)
+            buf->push_back(char(0x9f));
+        else
+            head(4, n);
+        return *this;
+    }
+
+    // start an object of n key/value pairs, or of pairs up to a matching end()
+    CborWriter &beginObject(size_t n = unknownSize)
+    {
+        if (n == unknownSize)
+            buf->push_back(char(0xbf));
+        else
+            head(5, n);
+        return *this;
+    }
+
+    // close the innermost container started with unknownSize
+    CborWriter &end()
+    {
+        buf->push_back(char(0xff));
+        return done();
+    }
+
+    // hand buffered output to the ostream, if there is one
+    void flush()
+    {
+        if (!sink || buf->empty())
+            return;
+        sink->write(buf->data(), buf->size());
+        buf->clear();
+    }
+};
+
+// ========== cbor parser
+
+// decodes one cbor item into a Json tree. byte strings become strings, tags are
+// ignored and undefined becomes null. containers with and without lengths are accepted
+class CborParser
+{
+private:
+    static const size_t maxDepth = 1 << 10;
+
+    const uint8_t *p = nullptr;
+    const uint8_t *last = nullptr;
+    string err;
+
+    bool fail(string e)
+    {
+        if (err.empty())
+            err = std::move(e);
+        return false;
+    }
+
+    bool read(size_t bytes, uint64_t &n)
+    {
+        if (size_t(last - p) < bytes)
+            return fail("Unexpected end of input.");
+        n = 0;
+        for (size_t i = 0; i < bytes; i++)
+            n = n << 8 | *p++;
+        return true;
+    }
+
+    // argument of the item whose additional info is info, indefinite is set for info 31
+    bool argument(uint8_t info, uint64_t &n, bool &indefinite)
+    {
+        indefinite = false;
+        if (info < 24)
+        {
+            n = info;
+            return true;
+        }
+        if (info <= 27)
+            return read(size_t(1) << (info - 24), n);
+        if (info == 31)
+        {
+            indefinite = true;
+            return true;
+        }
+        return fail("Invalid additional information " + to_string(info) + ".");
+    }
+
+    bool isBreak()
+    {
+        if (p != last && *p == 0xff)
+        {
+            p++;
+            return true;
+        }
+        return false;
+    }
+
+    // append the contents of a text or byte string of major type major to s
+    bool parseString(uint8_t major, uint8_t info, string &s)
+    {
+        uint64_t n;
+        bool indefinite;
+        if (!argument(info, n, indefinite))
+            return false;
+        if (!indefinite)
+        {
+            if (uint64_t(last - p) < n)
+                return fail("Unexpected end of input.");
+            s.append(reinterpret_cast<const char *>(p), size_t(n));
+            p += n;
+            return true;
+        }
+        // chunks of the same major type up to a break
+        while (!isBreak())
+        {
+            if (p == last)
+                return fail("Unexpected end of input.");
+            uint8_t b = *p++;
+            if (b >> 5 != major || (b & 0x1f) == 31)
+                return fail("Invalid string chunk.");
+            if (!parseString(major, b & 0x1f, s))
+                return false;
+        }
+        return true;
+    }
+
+    static double halfToDouble(uint16_t h)
+    {
+        int exp = (h >> 10) & 0x1f;
+        int mant = h & 0x3ff;
+        double d;
+        if (exp == 0)
+            d = ldexp(mant, -24);
+        else if (exp != 31)
+            d = ldexp(mant + 1024, exp - 25);
+        else
+            d = mant == 0 ? HUGE_VAL : NAN;
+        return h & 0x8000 ? -d : d;
+    }
+
+    bool parseValue(Json &out, size_t depth)
+    {
+        if (p == last)
+            return fail("Unexpected end of input.");
+        if (depth > maxDepth)
+            return fail("Nesting too deep.");
+        uint8_t b = *p++;
+        uint8_t major = b >> 5, info = b & 0x1f;
+        uint64_t n;
+        bool indefinite;
+        switch (major)
+        {
+        case 0: // unsigned integer, in the smallest type that fits like parseJson does
+            if (!argument(info, n, indefinite) || indefinite)
+                return fail("Invalid integer.");
+            if (n <= uint64_t(INT32_MAX))
+                out = Json(int(n));
+            else if (n <= uint64_t(INT64_MAX))
+                out = Json(int64_t(n));
+            else
+                out = Json(n);
+            return true;
+        case 1: // negative integer -1 - n
+            if (!argument(info, n, indefinite) || indefinite)
+                return fail("Invalid integer.");
+            if (n <= uint64_t(INT32_MAX))
+                out = Json(int(-1 - int64_t(n)));
+            else if (n <= uint64_t(INT64_MAX))
+                out = Json(-1 - int64_t(n));
+            else
+                out = Json(-1.0 - double(n));
+            return true;
+        case 2:
+        case 3:
+        {
+            string &s = JsonFill::str(out);
+            s.clear();
+            return parseString(major, info, s);
+        }
+        case 4:
+        {
+            if (!argument(info, n, indefinite))
+                return false;
+            out = JsonArray();
+            vector<Json> &arr = JsonFill::arr(out);
+            if (indefinite)
+            {
+                while (!isBreak())
+                    if (!parseValue(arr.emplace_back(), depth + 1))
+                        return false;
+                return true;
+            }
+            // every element takes at least one byte, a bad length cannot reserve more than that
+            arr.reserve(size_t(min<uint64_t>(n, last - p)));
+            for (uint64_t i = 0; i < n; i++)
+                if (!parseValue(arr.emplace_back(), depth + 1))
+                    return false;
+            return true;
+        }
+        case 5:
+        {
+            if (!argument(info, n, indefinite))
+                return false;
+            out = JsonObject();
+            if (!indefinite)
+                out.reserve(size_t(min<uint64_t>(n, (last - p) / 2)));
+            string key;
+            for (uint64_t i = 0; indefinite || i < n; i++)
+            {
+                if (indefinite && isBreak())
+                    break;
+                if (p == last)
+                    return fail("Unexpected end of input.");
+                uint8_t k = *p++;
+                if (k >> 5 != 3)
+                    return fail("Object key is not a string.");
+                key.clear();
+                if (!parseString(3, k & 0x1f, key))
+                    return false;
+                // a repeated key takes the last value, as in parseJson
+                Json &member = JsonFill::obj(out).try_emplace(std::move(key)).first->second;
+                if (!parseValue(member, depth + 1))
+                    return false;
+            }
+            return true;
+        }
+        case 6: // tag, the tagged item is decoded as it is
+            if (!argument(info, n, indefinite) || indefinite)
+                return fail("Invalid tag.");
+            return parseValue(out, depth + 1);
+        default:
+            break;
+        }
+
+        // major type 7, simple values and floats
+        switch (info)
+        {
+        case 20:
+        case 21:
+            out = Json(info == 21);
+            return true;
+        case 22:
+        case 23:
+            out = Json();
+            return true;
+        case 25:
+            if (!read(2, n))
+                return false;
+            out = Json(halfToDouble(uint16_t(n)));
+            return true;
+        case 26:
+        {
+            if (!read(4, n))
+                return false;
+            uint32_t bits = uint32_t(n);
+            float f;
+            memcpy(&f, &bits, sizeof(f));
+            out = Json(double(f));
+            return true;
+        }
+        case 27:
+        {
+            if (!read(8, n))
+                return false;
+            double d;
+            memcpy(&d, &n, sizeof(d));
+            out = Json(d);
+            return true;
+        }
+        case 31:
+            return fail("Unexpected break.");
+        default:
+            return fail("Unsupported simple value " + to_string(info) + ".");
+        }
+    }
+
+public:
+    ParseResult parse(string_view s)
+    {
+        p = reinterpret_cast<const uint8_t *>(s.data());
+        last = p + s.size();
+        err.clear();
+        Json res;
+        if (!parseValue(res, 0))
+            return ParseResult().setError(err);
+        if (p != last)
+            return ParseResult().setError("Unexpected data after the end of the item.");
+        return ParseResult().setJson(std::move(res));
+    }
+};
+
+inline string dumpCbor(const Json &json)
+{
+    string res;
+    CborWriter(res).write(json);
+    return res;
+}
+
+inline ParseResult parseCbor(string_view s)
+{
+    return CborParser().parse(s);
+}
+
+inline ParseResult readCbor(const string &filepath)
+{
+    JsonFileBuffer file(filepath);
+    if (!file.isOpen())
+        return ParseResult().setError("file " + filepath + " not found!");
+    return parseCbor(file.view());
+}
+
+#endif // JSON_CBOR_H
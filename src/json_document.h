@@ -0,0 +1,569 @@
+/*
+    arena backed, read-only json documents.
+
+    every node and string byte of a parsed document lives in one monotonic arena
+    owned by the JsonDocument, so dropping the document frees the whole tree at once
+    instead of walking it node by node.
+
+    JsonDocument doc;
+    if (!doc.read("test/test2.json"))
+        cout << doc.getError() << endl;
+    cout << doc.root()["web-app"]["servlet"][1]["servlet-name"].getString() << endl;
+*/
+
+#ifndef JSON_DOCUMENT_H
+#define JSON_DOCUMENT_H
+
+#include <cstring>
+#include <cstddef>
+#include <unordered_set>
+#include "json.h"
+
+// ========== arena
+
+// monotonic allocator, memory is only given back all at once by release()
+class JsonArena
+{
+private:
+    struct Block
+    {
+        Block *next;
+        size_t size;
+    };
+
+    static const size_t minBlockSize = 1 << 16;
+    static const size_t maxBlockSize = 1 << 24;
+
+    Block *head = nullptr;
+    char *cur = nullptr;
+    char *end = nullptr;
+    size_t nextBlockSize = minBlockSize;
+    size_t blocks = 0;
+    size_t used = 0;
+
+    void grow(size_t n)
+    {
+        size_t size = nextBlockSize;
+        if (size < n + alignof(max_align_t))
+            size = n + alignof(max_align_t);
+        Block *block = static_cast<Block *>(::operator new(sizeof(Block) + size));
+        block->next = head;
+        block->size = size;
+        head = block;
+        cur = reinterpret_cast<char *>(block + 1);
+        end = cur + size;
+        blocks++;
+        if (nextBlockSize < maxBlockSize)
+            nextBlockSize *= 2;
+    }
+
+public:
+    JsonArena() = default;
+    ~JsonArena() { release(); }
+
+    JsonArena(const JsonArena &) = delete;
+    JsonArena &operator=(const JsonArena &) = delete;
+
+    void *allocate(size_t n, size_t align = alignof(max_align_t))
+    {
+        size_t pad = (align - reinterpret_cast<uintptr_t>(cur) % align) % align;
+        if (cur == nullptr || size_t(end - cur) < n + pad)
+        {
+            grow(n + align);
+            pad = (align - reinterpret_cast<uintptr_t>(cur) % align) % align;
+        }
+        char *p = cur + pad;
+        cur = p + n;
+        used += n;
+        return p;
+    }
+
+    // free every block, all pointers handed out become invalid
+    void release()
+    {
+        while (head)
+        {
+            Block *next = head->next;
+            ::operator delete(head);
+            head = next;
+        }
+        cur = end = nullptr;
+        nextBlockSize = minBlockSize;
+        blocks = 0;
+        used = 0;
+    }
+
+    size_t bytesUsed() const { return used; }
+    size_t blockCount() const { return blocks; }
+};
+
+// ========== document nodes
+
+// a 16 byte node of an arena document. strings of up to 14 bytes are kept in the node
+// itself, longer ones point into the arena. arrays and objects point to a contiguous
+// span of child nodes, objects store key, value, key, value, ...
+struct JsonNode
+{
+    static const size_t shortCapacity = 14;
+    static const uint8_t notShort = 0xff;
+
+    uint8_t type;      // a Json::JsonType
+    uint8_t shortSize; // length of a string kept in the node, notShort otherwise
+    uint16_t unused;
+    uint32_t size; // string length, element or member count
+    union
+    {
+        bool bValue;
+        int iValue;
+        int64_t i64Value;
+        uint64_t u64Value;
+        double dValue;
+        const char *sValue;
+        const JsonNode *children;
+    };
+
+    // a short string overlays every byte after shortSize
+    char *shortData() { return reinterpret_cast<char *>(this) + 2; }
+    const char *shortData() const { return reinterpret_cast<const char *>(this) + 2; }
+
+    Json::JsonType getType() const { return static_cast<Json::JsonType>(type); }
+    string_view str() const
+    {
+        if (shortSize != notShort)
+            return string_view(shortData(), shortSize);
+        return string_view(sValue, size);
+    }
+};
+static_assert(sizeof(JsonNode) == 16, "JsonNode is expected to be 16 bytes");
+
+// read-only view of a document node, mirrors the accessors of Json
+class JsonElement
+{
+private:
+    const JsonNode *node;
+
+public:
+    explicit JsonElement(const JsonNode *node) : node(node) {}
+
+    // Type functions
+    Json::JsonType getType() const { return node->getType(); }
+    bool isNull() const { return node->getType() == Json::JsonType::JT_NULL; }
+    bool isBool() const { return node->getType() == Json::JsonType::JT_BOOL; }
+    bool isInt() const { return node->getType() == Json::JsonType::JT_INT; }
+    bool isInt64() const { return node->getType() == Json::JsonType::JT_INT64; }
+    bool isUInt64() const { return node->getType() == Json::JsonType::JT_UINT64; }
+    bool isDouble() const { return node->getType() == Json::JsonType::JT_DOUBLE; }
+    bool isString() const { return node->getType() == Json::JsonType::JT_STRING; }
+    bool isArray() const { return node->getType() == Json::JsonType::JT_ARRAY; }
+    bool isObject() const { return node->getType() == Json::JsonType::JT_OBJECT; }
+
+    // get values
+    bool getBool() const
+    {
+        if (!isBool())
+            throw "Error: not-bool!";
+        return node->bValue;
+    }
+    int getInt() const
+    {
+        if (!isInt())
+            throw "Error: not-Int!";
+        return node->iValue;
+    }
+    int64_t getInt64() const
+    {
+        if (!isInt64())
+            throw "Error: not-Int64!";
+        return node->i64Value;
+    }
+    uint64_t getUInt64() const
+    {
+        if (!isUInt64())
+            throw "Error: not-UInt64!";
+        return node->u64Value;
+    }
+    double getDouble() const
+    {
+        if (!isDouble())
+            throw "Error: not-Double!";
+        return node->dValue;
+    }
+    string_view getString() const
+    {
+        if (!isString())
+            throw "Error: not-String!";
+        return node->str();
+    }
+
+    // size function
+
+    size_t size() const
+    {
+        if (isArray() || isObject())
+            return node->size;
+        return -1;
+    }
+
+    // access operators
+
+    JsonElement operator[](size_t index) const
+    {
+        if (!isArray())
+            throw "Error: Not an json array!";
+        if (index >= node->size)
+            throw "Error: out-of-bound error!";
+        return JsonElement(node->children + index);
+    }
+
+    JsonElement operator[](string_view key) const
+    {
+        if (!isObject())
+            throw "Error: Not an json object!";
+        const JsonNode *member = find(key);
+        if (member == nullptr)
+            throw "Error: key not found!";
+        return JsonElement(member);
+    }
+
+    JsonElement at(size_t index) const { return operator[](index); }
+    JsonElement at(string_view key) const { return operator[](key); }
+
+    bool contains(string_view key) const { return isObject() && find(key) != nullptr; }
+
+    // object members in document order
+    string_view keyAt(size_t index) const
+    {
+        if (!isObject())
+            throw "Error: Not an json object!";
+        if (index >= node->size)
+            throw "Error: out-of-bound error!";
+        return JsonElement(node->children + 2 * index).getString();
+    }
+    JsonElement valueAt(size_t index) const
+    {
+        if (!isObject())
+            throw "Error: Not an json object!";
+        if (index >= node->size)
+            throw "Error: out-of-bound error!";
+        return JsonElement(node->children + 2 * index + 1);
+    }
+
+    // deep copy into a heap allocated Json
+    Json toJson() const
+    {
+        switch (node->getType())
+        {
+        case Json::JsonType::JT_NULL:
+            return Json();
+        case Json::JsonType::JT_BOOL:
+            return Json(node->bValue);
+        case Json::JsonType::JT_INT:
+            return Json(node->iValue);
+        case Json::JsonType::JT_INT64:
+            return Json(node->i64Value);
+        case Json::JsonType::JT_UINT64:
+            return Json(node->u64Value);
+        case Json::JsonType::JT_DOUBLE:
+            return Json(node->dValue);
+        case Json::JsonType::JT_STRING:
+            return Json(string(node->str()));
+        case Json::JsonType::JT_ARRAY:
+        {
+            Json res;
+            vector<Json> &arr = JsonFill::arr(res);
+            arr.reserve(node->size);
+            for (size_t i = 0; i < node->size; i++)
+                arr.push_back(JsonElement(node->children + i).toJson());
+            return res;
+        }
+        case Json::JsonType::JT_OBJECT:
+        {
+            Json res;
+            Json::ObjectType &members = JsonFill::obj(res);
+            for (size_t i = 0; i < node->size; i++)
+                members[string(keyAt(i))] = valueAt(i).toJson();
+            return res;
+        }
+        }
+        return Json();
+    }
+
+    string dump(int depth = 1, string tabStyle = "    ") const { return toJson().dump(depth, tabStyle); }
+
+private:
+    const JsonNode *find(string_view key) const
+    {
+        const JsonNode *member = node->children;
+        for (size_t i = 0; i < node->size; i++, member += 2)
+        {
+            string_view name = member->str();
+            // interned keys are equal exactly when they share storage, e.g. a key from keyAt()
+            // of another record of the same document
+            if (name.data() == key.data() && name.size() == key.size())
+                return member + 1;
+            if (name == key)
+                return member + 1;
+        }
+        return nullptr;
+    }
+};
+
+// ========== document
+
+class JsonDocument
+{
+private:
+    // handler placing the parsed nodes into the arena
+    class Builder : public JsonHandler
+    {
+    private:
+        JsonArena &arena;
+        vector<JsonNode> stack; // finished values whose container is still open
+        vector<size_t> bases;   // where the children of each open container start in stack
+        bool internKeys;
+        unordered_set<string_view> keys; // long keys already copied into the arena
+        vector<size_t> slots; // hash table of the keys of the object being closed, positions + 1
+        string err;
+
+        bool push(Json::JsonType type)
+        {
+            stack.emplace_back();
+            stack.back().type = static_cast<uint8_t>(type);
+            stack.back().shortSize = JsonNode::notShort;
+            stack.back().size = 0;
+            return true;
+        }
+
+        bool pushString(string_view s, bool isKey = false)
+        {
+            push(Json::JsonType::JT_STRING);
+            JsonNode &node = stack.back();
+            if (s.size() <= JsonNode::shortCapacity)
+            {
+                node.shortSize = s.size();
+                memcpy(node.shortData(), s.data(), s.size());
+                return true;
+            }
+            if (s.size() > UINT32_MAX)
+                return fail("Document too large.");
+            node.size = s.size();
+            if (isKey && internKeys)
+            {
+                auto it = keys.find(s);
+                if (it != keys.end())
+                {
+                    node.sValue = it->data();
+                    return true;
+                }
+            }
+            char *str = static_cast<char *>(arena.allocate(s.size(), 1));
+            memcpy(str, s.data(), s.size());
+            node.sValue = str;
+            if (isKey && internKeys && keys.size() < maxInternedKeys)
+                keys.insert(string_view(str, s.size()));
+            return true;
+        }
+
+        bool fail(string e)
+        {
+            err = e;
+            return false;
+        }
+
+        // drop repeated keys from count members, the first one keeps its place and takes
+        // the value of the last one, as in parseJson. returns the members left
+        size_t dropRepeatedKeys(JsonNode *member, size_t count)
+        {
+            static const size_t scanLimit = 8; // smaller objects are searched linearly
+            size_t mask = 0;
+            if (count > scanLimit)
+            {
+                size_t size = 32;
+                while (size < 2 * count)
+                    size *= 2;
+                slots.assign(size, 0);
+                mask = size - 1;
+            }
+            size_t out = 0;
+            for (size_t i = 0; i < count; i++)
+            {
+                string_view key = member[2 * i].str();
+                size_t j = 0;
+                if (count <= scanLimit)
+                {
+                    while (j < out && member[2 * j].str() != key)
+                        j++;
+                }
+                else
+                {
+                    size_t h = hash<string_view>()(key) & mask;
+                    while (slots[h] != 0 && member[2 * (slots[h] - 1)].str() != key)
+                        h = (h + 1) & mask;
+                    if (slots[h] == 0)
+                        slots[h] = out + 1; // a new key, moved to out below
+                    j = slots[h] - 1;
+                }
+                if (j < out)
+                {
+                    member[2 * j + 1] = member[2 * i + 1];
+                    continue;
+                }
+                member[2 * out] = member[2 * i];
+                member[2 * out + 1] = member[2 * i + 1];
+                out++;
+            }
+            return out;
+        }
+
+        // move the children of the innermost container into the arena as one span
+        bool close(Json::JsonType type)
+        {
+            size_t base = bases.back();
+            bases.pop_back();
+            size_t n = stack.size() - base;
+            if (type == Json::JsonType::JT_OBJECT && n > 2)
+                n = 2 * dropRepeatedKeys(stack.data() + base, n / 2);
+            JsonNode *children = nullptr;
+            if (n > 0)
+            {
+                children = static_cast<JsonNode *>(arena.allocate(n * sizeof(JsonNode), alignof(JsonNode)));
+                memcpy(children, stack.data() + base, n * sizeof(JsonNode));
+            }
+            stack.resize(base);
+            if (n > UINT32_MAX)
+                return fail("Document too large.");
+            push(type);
+            stack.back().size = type == Json::JsonType::JT_OBJECT ? n / 2 : n;
+            stack.back().children = children;
+            return true;
+        }
+
+    public:
+        // documents with many distinct keys, e.g. objects used as maps, stop interning at this point
+        static const size_t maxInternedKeys = 1 << 16;
+
+        Builder(JsonArena &arena, bool internKeys) : arena(arena), internKeys(internKeys) {}
+
+        bool onNull() { return push(Json::JsonType::JT_NULL); }
+        bool onBool(bool b)
+        {
+            push(Json::JsonType::JT_BOOL);
+            stack.back().bValue = b;
+            return true;
+        }
+        bool onNumber(const Json &number)
+        {
+            push(number.getType());
+            if (number.isInt())
+                stack.back().iValue = number.getInt();
+            else if (number.isInt64())
+                stack.back().i64Value = number.getInt64();
+            else if (number.isUInt64())
+                stack.back().u64Value = number.getUInt64();
+            else
+                stack.back().dValue = number.getDouble();
+            return true;
+        }
+        bool onString(string_view s) { return pushString(s); }
+        bool onKey(string_view s) { return pushString(s, true); }
+        bool onStartArray()
+        {
+            bases.push_back(stack.size());
+            return true;
+        }
+        bool onEndArray() { return close(Json::JsonType::JT_ARRAY); }
+        bool onStartObject()
+        {
+            bases.push_back(stack.size());
+            return true;
+        }
+        bool onEndObject() { return close(Json::JsonType::JT_OBJECT); }
+
+        const JsonNode &getRoot() const { return stack.back(); }
+        string getError() const { return err; }
+    };
+
+    JsonArena arena;
+    JsonNode rootNode;
+    bool internKeys = true;
+    string err;
+
+    bool fail(string e)
+    {
+        err = e;
+        return false;
+    }
+
+public:
+    JsonDocument() { clear(); }
+
+    JsonDocument(const JsonDocument &) = delete;
+    JsonDocument &operator=(const JsonDocument &) = delete;
+
+    // parse text into this document, dropping whatever it held before.
+    // the text is not referenced after parse() returns
+    bool parse(string_view s)
+    {
+        clear();
+        Builder builder(arena, internKeys);
+        JsonEventParser<Builder> parser;
+        if (!parser.parse(s, builder))
+        {
+            arena.release();
+            return fail(parser.wasStopped() ? builder.getError() : parser.getError());
+        }
+        rootNode = builder.getRoot();
+        return true;
+    }
+
+    // parse a file into this document
+    bool read(const string &filepath)
+    {
+        JsonFileBuffer file(filepath);
+        if (!file.isOpen())
+        {
+            clear();
+            return fail("file " + filepath + " not found!");
+        }
+        return parse(file.view());
+    }
+
+    // drop the tree, freeing all of its memory at once
+    void clear()
+    {
+        arena.release();
+        rootNode.type = static_cast<uint8_t>(Json::JsonType::JT_NULL);
+        rootNode.shortSize = JsonNode::notShort;
+        err.clear();
+    }
+
+    bool isError() const { return !err.empty(); }
+    string getError() const { return err; }
+
+    // store every distinct object key once per document, on by default.
+    // keys of up to 14 bytes live in their nodes and are never shared
+    void setInternKeys(bool on) { internKeys = on; }
+    bool getInternKeys() const { return internKeys; }
+
+    JsonElement root() const { return JsonElement(&rootNode); }
+    JsonElement operator[](size_t index) const { return root()[index]; }
+    JsonElement operator[](string_view key) const { return root()[key]; }
+
+    // bytes of nodes and strings held by the arena
+    size_t bytesUsed() const { return arena.bytesUsed(); }
+    size_t blockCount() const { return arena.blockCount(); }
+};
+
+// parse text into an arena backed document
+inline bool parseJson(string_view s, JsonDocument &doc)
+{
+    return doc.parse(s);
+}
+
+// parse a file into an arena backed document
+inline bool readJson(const string &filepath, JsonDocument &doc)
+{
+    return doc.read(filepath);
+}
+
+#endif // JSON_DOCUMENT_H
@@ -0,0 +1,509 @@
+/*
+    flat json files, read in place without decoding.
+
+    a flat file is one block of 16 byte nodes and string bytes that refer to each other
+    by offsets from the start of the file, so opening one only maps it and checks its
+    header: nothing is parsed or allocated, and pages are read when a lookup touches them.
+    arrays are tables of nodes, objects are tables of keys sorted for binary search
+    followed by the table of their values.
+
+    writeJsonFlat(readJson("big.json").getJson(), "big.jsonf"); // once, offline
+
+    JsonFlatFile file;
+    if (!file.read("big.jsonf"))
+        cout << file.getError() << endl;
+    cout << file.root()["web-app"]["servlet"][1]["servlet-name"].getString() << endl;
+
+    the file uses the byte order of the machine that wrote it, and files written on
+    a machine with a different byte order are rejected.
+*/
+
+#ifndef JSON_FLAT_H
+#define JSON_FLAT_H
+
+#include <cstring>
+#include <cstddef>
+#include <memory>
+#include <algorithm>
+#include <unordered_map>
+#include "json.h"
+
+// ========== file layout
+
+// a node of a flat file. like a JsonNode, strings of up to 14 bytes are kept in the
+// node itself, longer strings and the children of containers are found at offset
+struct JsonFlatNode
+{
+    static const size_t shortCapacity = 14;
+    static const uint8_t notShort = 0xff;
+
+    uint8_t type;      // a Json::JsonType
+    uint8_t shortSize; // length of a string kept in the node, notShort otherwise
+    uint16_t unused;
+    uint32_t size; // string length, element or member count
+    union
+    {
+        uint64_t bValue; // 0 or 1, a damaged file cannot make it an invalid bool
+        int iValue;
+        int64_t i64Value;
+        uint64_t u64Value;
+        double dValue;
+        uint64_t offset; // from the start of the file
+    };
+
+    char *shortData() { return reinterpret_cast<char *>(this) + 2; }
+    const char *shortData() const { return reinterpret_cast<const char *>(this) + 2; }
+
+    Json::JsonType getType() const { return static_cast<Json::JsonType>(type); }
+};
+static_assert(sizeof(JsonFlatNode) == 16, "JsonFlatNode is expected to be 16 bytes");
+
+struct JsonFlatHeader
+{
+    static const uint32_t currentVersion = 1;
+    static const uint32_t byteOrderMark = 0x01020304;
+
+    char magic[4]; // "JSNF"
+    uint32_t version;
+    uint32_t byteOrder; // byteOrderMark as written
+    uint32_t unused;
+    uint64_t size; // of the whole file
+    JsonFlatNode root;
+};
+static_assert(sizeof(JsonFlatHeader) == 40, "JsonFlatHeader is expected to be 40 bytes");
+
+// ========== view
+
+// read-only view of a node of a flat file, mirrors the accessors of Json.
+// offsets are checked against the file before they are followed, so a damaged file
+// throws instead of reading outside of it
+class JsonFlatElement
+{
+private:
+    const char *base;
+    size_t len;
+    const JsonFlatNode *node;
+
+    // count children of this node starting at offset. children always come after their
+    // parent, which also keeps a damaged file from making a walk go around in circles
+    const JsonFlatNode *nodesAt(uint64_t offset, uint64_t count) const
+    {
+        size_t self = reinterpret_cast<const char *>(node) - base;
+        if (offset % alignof(JsonFlatNode) != 0 || offset <= self || offset > len ||
+            count > (len - offset) / sizeof(JsonFlatNode))
+            throw "Error: damaged flat json file!";
+        return reinterpret_cast<const JsonFlatNode *>(base + offset);
+    }
+
+    string_view str(const JsonFlatNode *n) const
+    {
+        if (n->shortSize <= JsonFlatNode::shortCapacity)
+            return string_view(n->shortData(), n->shortSize);
+        if (n->shortSize != JsonFlatNode::notShort || n->offset > len || n->size > len - n->offset)
+            throw "Error: damaged flat json file!";
+        return string_view(base + n->offset, n->size);
+    }
+
+    JsonFlatElement child(const JsonFlatNode *n) const { return JsonFlatElement(base, len, n); }
+
+public:
+    JsonFlatElement(const char *base, size_t len, const JsonFlatNode *node) : base(base), len(len), node(node) {}
+
+    // Type functions
+    Json::JsonType getType() const { return node->getType(); }
+    bool isNull() const { return node->getType() == Json::JsonType::JT_NULL; }
+    bool isBool() const { return node->getType() == Json::JsonType::JT_BOOL; }
+    bool isInt() const { return node->getType() == Json::JsonType::JT_INT; }
+    bool isInt64() const { return node->getType() == Json::JsonType::JT_INT64; }
+    bool isUInt64() const { return node->getType() == Json::JsonType::JT_UINT64; }
+    bool isDouble() const { return node->getType() == Json::JsonType::JT_DOUBLE; }
+    bool isString() const { return node->getType() == Json::JsonType::JT_STRING; }
+    bool isArray() const { return node->getType() == Json::JsonType::JT_ARRAY; }
+    bool isObject() const { return node->getType() == Json::JsonType::JT_OBJECT; }
+
+    // get values
+    bool getBool() const
+    {
+        if (!isBool())
+            throw "Error: not-bool!";
+        return node->bValue != 0;
+    }
+    int getInt() const
+    {
+        if (!isInt())
+            throw "Error: not-Int!";
+        return node->iValue;
+    }
+    int64_t getInt64() const
+    {
+        if (!isInt64())
+            throw "Error: not-Int64!";
+        return node->i64Value;
+    }
+    uint64_t getUInt64() const
+    {
+        if (!isUInt64())
+            throw "Error: not-UInt64!";
+        return node->u64Value;
+    }
+    double getDouble() const
+    {
+        if (!isDouble())
+            throw "Error: not-Double!";
+        return node->dValue;
+    }
+    // points into the file, valid while it is open
+    string_view getString() const
+    {
+        if (!isString())
+            throw "Error: not-String!";
+        return str(node);
+    }
+
+    // size function
+
+    size_t size() const
+    {
+        if (isArray() || isObject())
+            return node->size;
+        return -1;
+    }
+
+    // access operators
+
+    JsonFlatElement operator[](size_t index) const
+    {
+        if (!isArray())
+            throw "Error: Not an json array!";
+        if (index >= node->size)
+            throw "Error: out-of-bound error!";
+        return child(nodesAt(node->offset, node->size) + index);
+    }
+
+    JsonFlatElement operator[](string_view key) const
+    {
+        if (!isObject())
+            throw "Error: Not an json object!";
+        const JsonFlatNode *member = find(key);
+        if (member == nullptr)
+            throw "Error: key not found!";
+        return child(member);
+    }
+
+    JsonFlatElement at(size_t index) const { return operator[](index); }
+    JsonFlatElement at(string_view key) const { return operator[](key); }
+
+    bool contains(string_view key) const { return isObject() && find(key) != nullptr; }
+
+    // object members in key order
+    string_view keyAt(size_t index) const
+    {
+        if (!isObject())
+            throw "Error: Not an json object!";
+        if (index >= node->size)
+            throw "Error: out-of-bound error!";
+        return str(nodesAt(node->offset, 2 * uint64_t(node->size)) + index);
+    }
+    JsonFlatElement valueAt(size_t index) const
+    {
+        if (!isObject())
+            throw "Error: Not an json object!";
+        if (index >= node->size)
+            throw "Error: out-of-bound error!";
+        return child(nodesAt(node->offset, 2 * uint64_t(node->size)) + node->size + index);
+    }
+
+    // deep copy into a heap allocated Json
+    Json toJson() const
+    {
+        switch (node->getType())
+        {
+        case Json::JsonType::JT_NULL:
+            return Json();
+        case Json::JsonType::JT_BOOL:
+            return Json(node->bValue != 0);
+        case Json::JsonType::JT_INT:
+            return Json(node->iValue);
+        case Json::JsonType::JT_INT64:
+            return Json(node->i64Value);
+        case Json::JsonType::JT_UINT64:
+            return Json(node->u64Value);
+        case Json::JsonType::JT_DOUBLE:
+            return Json(node->dValue);
+        case Json::JsonType::JT_STRING:
+            return Json(string(str(node)));
+        case Json::JsonType::JT_ARRAY:
+        {
+            Json res;
+            vector<Json> &arr = JsonFill::arr(res);
+            arr.reserve(node->size);
+            for (size_t i = 0; i < node->size; i++)
+                arr.push_back(operator[](i).toJson());
+            return res;
+        }
+        case Json::JsonType::JT_OBJECT:
+        {
+            Json res;
+            Json::ObjectType &members = JsonFill::obj(res);
+            for (size_t i = 0; i < node->size; i++)
+                members[string(keyAt(i))] = valueAt(i).toJson();
+            return res;
+        }
+        }
+        return Json();
+    }
+
+    string dump(int depth = 1, string tabStyle = "    ") const { return toJson().dump(depth, tabStyle); }
+
+private:
+    // binary search of the sorted key table
+    const JsonFlatNode *find(string_view key) const
+    {
+        const JsonFlatNode *keys = nodesAt(node->offset, 2 * uint64_t(node->size));
+        size_t lo = 0, hi = node->size;
+        while (lo < hi)
+        {
+            size_t mid = lo + (hi - lo) / 2;
+            int cmp = str(keys + mid).compare(key);
+            if (cmp == 0)
+                return keys + node->size + mid;
+            if (cmp < 0)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return nullptr;
+    }
+};
+
+// ========== writer
+
+// lays a Json tree out as a flat file in memory. the children of a container are
+// placed right after it, so a walk over the file reads it mostly front to back
+class JsonFlatWriter
+{
+private:
+    string &out;
+    unordered_map<string_view, uint64_t> keys; // where each long key was stored, they are written once
+
+    // room for n zeroed bytes at the end, 8 byte aligned
+    size_t allocate(size_t n)
+    {
+        size_t at = (out.size() + 7) & ~size_t(7);
+        out.resize(at + n);
+        return at;
+    }
+
+    static uint32_t checkedSize(size_t n)
+    {
+        if (n > UINT32_MAX)
+            throw "Error: value too large for a flat json file!";
+        return uint32_t(n);
+    }
+
+    void setString(JsonFlatNode &n, string_view s, bool isKey = false)
+    {
+        n.type = static_cast<uint8_t>(Json::JsonType::JT_STRING);
+        if (s.size() <= JsonFlatNode::shortCapacity)
+        {
+            n.shortSize = uint8_t(s.size());
+            memcpy(n.shortData(), s.data(), s.size());
+            return;
+        }
+        n.size = checkedSize(s.size());
+        if (isKey)
+        {
+            auto it = keys.find(s);
+            if (it != keys.end())
+            {
+                n.offset = it->second;
+                return;
+            }
+        }
+        n.offset = allocate(s.size());
+        memcpy(&out[n.offset], s.data(), s.size());
+        if (isKey)
+            keys.emplace(s, n.offset);
+    }
+
+    // fill the node at offset at with json, and place what it refers to
+    void place(const Json &json, size_t at)
+    {
+        JsonFlatNode n;
+        memset(&n, 0, sizeof(n));
+        n.type = static_cast<uint8_t>(json.getType());
+        n.shortSize = JsonFlatNode::notShort;
+        switch (json.getType())
+        {
+        case Json::JsonType::JT_NULL:
+            break;
+        case Json::JsonType::JT_BOOL:
+            n.bValue = json.getBool();
+            break;
+        case Json::JsonType::JT_INT:
+            n.iValue = json.getInt();
+            break;
+        case Json::JsonType::JT_INT64:
+            n.i64Value = json.getInt64();
+            break;
+        case Json::JsonType::JT_UINT64:
+            n.u64Value = json.getUInt64();
+            break;
+        case Json::JsonType::JT_DOUBLE:
+            n.dValue = json.getDouble();
+            break;
+        case Json::JsonType::JT_STRING:
+            setString(n, json.getString());
+            break;
+        case Json::JsonType::JT_ARRAY:
+        {
+            const auto &arr = json.getArray();
+            n.size = checkedSize(arr.size());
+            n.offset = allocate(arr.size() * sizeof(JsonFlatNode));
+            for (size_t i = 0; i < arr.size(); i++)
+                place(arr[i], n.offset + i * sizeof(JsonFlatNode));
+            break;
+        }
+        case Json::JsonType::JT_OBJECT:
+        {
+            const auto &obj = json.getObject();
+            vector<const Json::ObjectType::value_type *> members;
+            members.reserve(obj.size());
+            for (const auto &p : obj)
+                members.push_back(&p);
+#ifdef JSON_ORDERED_OBJECT
+            // the key table is searched in byte order
+            sort(members.begin(), members.end(), [](auto a, auto b) { return a->first < b->first; });
+#endif
+            n.size = checkedSize(members.size());
+            n.offset = allocate(2 * members.size() * sizeof(JsonFlatNode));
+            for (size_t i = 0; i < members.size(); i++)
+            {
+                JsonFlatNode key;
+                memset(&key, 0, sizeof(key));
+                key.shortSize = JsonFlatNode::notShort;
+                setString(key, members[i]->first, true);
+                memcpy(&out[n.offset + i * sizeof(JsonFlatNode)], &key, sizeof(key));
+            }
+            for (size_t i = 0; i < members.size(); i++)
+                place(members[i]->second, n.offset + (members.size() + i) * sizeof(JsonFlatNode));
+            break;
+        }
+        }
+        memcpy(&out[at], &n, sizeof(n));
+    }
+
+public:
+    explicit JsonFlatWriter(string &out) : out(out) {}
+
+    // replace the contents of out with json as a flat file
+    void write(const Json &json)
+    {
+        out.clear();
+        keys.clear();
+        allocate(sizeof(JsonFlatHeader));
+        place(json, offsetof(JsonFlatHeader, root));
+        JsonFlatHeader header;
+        memcpy(&header, &out[0], sizeof(header));
+        memcpy(header.magic, "JSNF", 4);
+        header.version = JsonFlatHeader::currentVersion;
+        header.byteOrder = JsonFlatHeader::byteOrderMark;
+        header.unused = 0;
+        header.size = out.size();
+        memcpy(&out[0], &header, sizeof(header));
+    }
+};
+
+// json as the contents of a flat file
+inline string dumpJsonFlat(const Json &json)
+{
+    string res;
+    JsonFlatWriter(res).write(json);
+    return res;
+}
+
+// write json to a flat file, returns false if the file could not be written
+inline bool writeJsonFlat(const Json &json, const string &filepath)
+{
+    string data = dumpJsonFlat(json);
+    ofstream fout(filepath, ios::binary | ios::trunc);
+    fout.write(data.data(), data.size());
+    return bool(fout);
+}
+
+// ========== file
+
+class JsonFlatFile
+{
+private:
+    unique_ptr<JsonFileBuffer> file;
+    string_view src;
+    string err;
+
+    bool fail(string e)
+    {
+        err = e;
+        src = string_view();
+        return false;
+    }
+
+public:
+    JsonFlatFile() = default;
+    JsonFlatFile(const JsonFlatFile &) = delete;
+    JsonFlatFile &operator=(const JsonFlatFile &) = delete;
+
+    // use s in place after checking its header. s is referenced, not copied, and has to
+    // outlive the file; it has to be 8 byte aligned, as buffers from new and mmap are
+    bool parse(string_view s)
+    {
+        err.clear();
+        src = s;
+        if (s.size() < sizeof(JsonFlatHeader) || reinterpret_cast<uintptr_t>(s.data()) % alignof(JsonFlatNode) != 0)
+            return fail("Not a flat json file.");
+        const JsonFlatHeader &header = *reinterpret_cast<const JsonFlatHeader *>(s.data());
+        if (memcmp(header.magic, "JSNF", 4) != 0)
+            return fail("Not a flat json file.");
+        if (header.byteOrder != JsonFlatHeader::byteOrderMark)
+            return fail("Flat json file has a different byte order.");
+        if (header.version != JsonFlatHeader::currentVersion)
+            return fail("Unsupported flat json version " + to_string(header.version) + ".");
+        if (header.size != s.size())
+            return fail("Flat json file is truncated.");
+        return true;
+    }
+
+    // map the file and check its header, the mapping is kept until the file is closed
+    bool read(const string &filepath)
+    {
+        file.reset(new JsonFileBuffer(filepath, false));
+        if (!file->isOpen())
+        {
+            file.reset();
+            return fail("file " + filepath + " not found!");
+        }
+        return parse(file->view());
+    }
+
+    void close()
+    {
+        file.reset();
+        src = string_view();
+        err.clear();
+    }
+
+    bool isOpen() const { return !src.empty(); }
+    bool isError() const { return !err.empty(); }
+    string getError() const { return err; }
+
+    JsonFlatElement root() const
+    {
+        if (!isOpen())
+            throw "Error: flat json file is not open!";
+        const JsonFlatHeader *header = reinterpret_cast<const JsonFlatHeader *>(src.data());
+        return JsonFlatElement(src.data(), src.size(), &header->root);
+    }
+    JsonFlatElement operator[](size_t index) const { return root()[index]; }
+    JsonFlatElement operator[](string_view key) const { return root()[key]; }
+};
+
+#endif // JSON_FLAT_H
@@ -0,0 +1,361 @@
+/*
+    two-stage json parsing.
+
+    stage one scans the whole input in 64 byte blocks and records the position of every
+    structural character ({ } [ ] : ,), every opening quote and the first byte of every
+    number or constant that is outside a string. stage two builds the Json by walking
+    that index, so it never has to look at whitespace or search for the next token.
+
+    auto res = parseJsonIndexed(text); // same results as parseJson(text)
+*/
+
+#ifndef JSON_INDEX_H
+#define JSON_INDEX_H
+
+#include <cstring>
+#include "json.h"
+
+// ========== stage one: structural index
+
+class JsonStructuralIndex
+{
+private:
+    // bitmasks of one 64 byte block, bit i describes byte i
+    struct BlockMasks
+    {
+        uint64_t quote;
+        uint64_t backslash;
+        uint64_t op; // { } [ ] : ,
+        uint64_t space;
+    };
+
+    vector<uint32_t> positions;
+    bool openString = false;
+    string err;
+
+    static bool isOp(char c)
+    {
+        return c == '{' || c == '}' || c == '[' || c == ']' || c == ':' || c == ',';
+    }
+
+    static void classifyScalar(const char *p, BlockMasks &m)
+    {
+        m = BlockMasks{0, 0, 0, 0};
+        for (int i = 0; i < 64; i++)
+        {
+            uint64_t bit = uint64_t(1) << i;
+            if (p[i] == '"')
+                m.quote |= bit;
+            else if (p[i] == '\\')
+                m.backslash |= bit;
+            else if (isOp(p[i]))
+                m.op |= bit;
+            else if (isJsonSpace(p[i]))
+                m.space |= bit;
+        }
+    }
+
+#ifdef JSON_HAS_SSE2
+    static void classifySse2(const char *p, BlockMasks &m)
+    {
+        m = BlockMasks{0, 0, 0, 0};
+        for (int k = 0; k < 4; k++)
+        {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 16 * k));
+            __m128i op = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('{')), _mm_cmpeq_epi8(x, _mm_set1_epi8('}'))),
+                                      _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('[')), _mm_cmpeq_epi8(x, _mm_set1_epi8(']'))));
+            op = _mm_or_si128(op, _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8(':')), _mm_cmpeq_epi8(x, _mm_set1_epi8(','))));
+            __m128i ctrl = _mm_sub_epi8(x, _mm_set1_epi8('\t'));
+            ctrl = _mm_cmpeq_epi8(_mm_min_epu8(ctrl, _mm_set1_epi8('\r' - '\t')), ctrl);
+            __m128i space = _mm_or_si128(ctrl, _mm_cmpeq_epi8(x, _mm_set1_epi8(' ')));
+            m.quote |= uint64_t(_mm_movemask_epi8(_mm_cmpeq_epi8(x, _mm_set1_epi8('"')))) << (16 * k);
+            m.backslash |= uint64_t(_mm_movemask_epi8(_mm_cmpeq_epi8(x, _mm_set1_epi8('\\')))) << (16 * k);
+            m.op |= uint64_t(_mm_movemask_epi8(op)) << (16 * k);
+            m.space |= uint64_t(_mm_movemask_epi8(space)) << (16 * k);
+        }
+    }
+
+    __attribute__((target("avx2"))) static void classifyAvx2(const char *p, BlockMasks &m)
+    {
+        m = BlockMasks{0, 0, 0, 0};
+        for (int k = 0; k < 2; k++)
+        {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + 32 * k));
+            __m256i op = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('{')), _mm256_cmpeq_epi8(x, _mm256_set1_epi8('}'))),
+                                         _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('[')), _mm256_cmpeq_epi8(x, _mm256_set1_epi8(']'))));
+            op = _mm256_or_si256(op, _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8(':')), _mm256_cmpeq_epi8(x, _mm256_set1_epi8(','))));
+            __m256i ctrl = _mm256_sub_epi8(x, _mm256_set1_epi8('\t'));
+            ctrl = _mm256_cmpeq_epi8(_mm256_min_epu8(ctrl, _mm256_set1_epi8('\r' - '\t')), ctrl);
+            __m256i space = _mm256_or_si256(ctrl, _mm256_cmpeq_epi8(x, _mm256_set1_epi8(' ')));
+            m.quote |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('"'))))) << (32 * k);
+            m.backslash |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('\\'))))) << (32 * k);
+            m.op |= uint64_t(uint32_t(_mm256_movemask_epi8(op))) << (32 * k);
+            m.space |= uint64_t(uint32_t(_mm256_movemask_epi8(space))) << (32 * k);
+        }
+    }
+#endif
+
+    static uint64_t prefixXor(uint64_t x)
+    {
+        x ^= x << 1;
+        x ^= x << 2;
+        x ^= x << 4;
+        x ^= x << 8;
+        x ^= x << 16;
+        x ^= x << 32;
+        return x;
+    }
+
+    static int lowestBit(uint64_t x)
+    {
+#ifdef __GNUC__
+        return __builtin_ctzll(x);
+#else
+        int i = 0;
+        while (!(x & 1))
+        {
+            x >>= 1;
+            i++;
+        }
+        return i;
+#endif
+    }
+
+public:
+    // index s, returns false if it is too big for 32-bit positions.
+    // an unterminated string is indexed up to its opening quote, see endsInString()
+    bool build(string_view s)
+    {
+        positions.clear();
+        openString = false;
+        err.clear();
+        if (s.size() >= UINT32_MAX)
+        {
+            err = "Document too large for the structural index.";
+            return false;
+        }
+
+        void (*classify)(const char *, BlockMasks &) = classifyScalar;
+#ifdef JSON_HAS_SSE2
+        classify = jsonHasAvx2() ? classifyAvx2 : classifySse2;
+#endif
+
+        uint64_t prevInString = 0; // all ones while a string continues into the next block
+        uint64_t prevScalar = 0;   // 1 if the previous block ended inside a number or constant
+        uint64_t escapeCarry = 0;  // 1 if the first byte of the next block is escaped
+        char tail[64];
+        for (size_t base = 0; base < s.size(); base += 64)
+        {
+            const char *block = s.data() + base;
+            if (s.size() - base < 64)
+            {
+                // pad the last block with whitespace
+                memset(tail, ' ', sizeof(tail));
+                memcpy(tail, block, s.size() - base);
+                block = tail;
+            }
+            BlockMasks m;
+            classify(block, m);
+
+            // bytes escaped by a backslash, only worked out for blocks that have one
+            uint64_t escaped = escapeCarry;
+            escapeCarry = 0;
+            for (uint64_t bits = m.backslash; bits != 0; bits &= bits - 1)
+            {
+                int i = lowestBit(bits);
+                if ((escaped >> i) & 1)
+                    continue;
+                if (i == 63)
+                    escapeCarry = 1;
+                else
+                    escaped |= uint64_t(1) << (i + 1);
+            }
+
+            // inString covers the opening quote and the contents, not the closing quote
+            uint64_t quotes = m.quote & ~escaped;
+            uint64_t inString = prefixXor(quotes) ^ prevInString;
+            prevInString = uint64_t(int64_t(inString) >> 63);
+
+            uint64_t scalar = ~(m.op | m.space | quotes | inString);
+            uint64_t scalarStarts = scalar & ~((scalar << 1) | prevScalar);
+            prevScalar = scalar >> 63;
+
+            uint64_t structurals = (m.op & ~inString) | (quotes & inString) | scalarStarts;
+            for (; structurals != 0; structurals &= structurals - 1)
+                positions.push_back(uint32_t(base + lowestBit(structurals)));
+        }
+        openString = prevInString != 0;
+        return true;
+    }
+
+    // the last string of the input has no closing quote
+    bool endsInString() const { return openString; }
+    size_t size() const { return positions.size(); }
+    uint32_t operator[](size_t i) const { return positions[i]; }
+    const vector<uint32_t> &getPositions() const { return positions; }
+    string getError() const { return err; }
+};
+
+// ========== stage two: Json construction
+
+class JsonIndexedBuilder
+{
+private:
+    string_view src;
+    const JsonStructuralIndex &index;
+    size_t cur = 0;
+    string err;
+
+    char token() const { return cur < index.size() ? src[index[cur]] : 0; }
+    const char *tokenStart() const { return src.data() + index[cur]; }
+    const char *srcEnd() const { return src.data() + src.size(); }
+
+    bool fail(string e)
+    {
+        err = e;
+        return false;
+    }
+
+    static bool endsToken(const char *p, const char *last)
+    {
+        return p == last || isJsonSpace(*p) || *p == ',' || *p == ']' || *p == '}' || *p == ':' || *p == '[' || *p == '{' || *p == '"';
+    }
+
+    bool parseString(string &out)
+    {
+        const char *first = tokenStart() + 1;
+        const char *close = scanJsonString(first, srcEnd());
+        if (close == srcEnd())
+            return fail("Expected '\"'.");
+        out.resize(close - first);
+        out.resize(unescapeJsonString(first, close, &out[0]) - out.data());
+        cur++;
+        return true;
+    }
+
+    bool parseConstant(string_view name, Json value, Json &out)
+    {
+        const char *p = tokenStart();
+        if (size_t(srcEnd() - p) < name.size() || memcmp(p, name.data(), name.size()) != 0 ||
+            (p + name.size() != srcEnd() && (isalnum(p[name.size()]) || p[name.size()] == '_')))
+            return fail("Unexpected Constant.");
+        if (!endsToken(p + name.size(), srcEnd()))
+            return fail("Something went wrong!");
+        out = value;
+        cur++;
+        return true;
+    }
+
+    bool parseNumber(Json &out)
+    {
+        const char *end = parseJsonNumber(tokenStart(), srcEnd(), out);
+        if (end == nullptr)
+            return fail("Invalid number.");
+        if (!endsToken(end, srcEnd()))
+            return fail("Something went wrong!");
+        cur++;
+        return true;
+    }
+
+    bool parseArray(Json &out)
+    {
+        cur++; // [
+        auto &arr = JsonFill::arr(out);
+        while (!atEnd() && token() != ']')
+        {
+            arr.emplace_back();
+            if (!parseValue(arr.back()))
+                return false;
+            if (token() != ',')
+                break;
+            cur++; // ,
+        }
+        if (token() != ']')
+            return fail("Expected ']'.");
+        cur++; // ]
+        return true;
+    }
+
+    bool parseObject(Json &out)
+    {
+        cur++; // {
+        auto &obj = JsonFill::obj(out);
+        string key;
+        while (!atEnd() && token() != '}')
+        {
+            if (token() != '"')
+                return fail("Expected '\"'.");
+            if (!parseString(key))
+                return false;
+            if (token() != ':')
+                return fail("Expected ':'.");
+            cur++; // :
+            if (!parseValue(obj[key]))
+                return false;
+            if (token() != ',')
+                break;
+            cur++; // ,
+        }
+        if (token() != '}')
+            return fail("Expected '}'.");
+        cur++; // }
+        return true;
+    }
+
+public:
+    // build from the value whose first token is index[start]
+    JsonIndexedBuilder(string_view src, const JsonStructuralIndex &index, size_t start = 0)
+        : src(src), index(index), cur(start) {}
+
+    bool parseValue(Json &out)
+    {
+        out.setType(Json::JsonType::JT_NULL); // a repeated key starts over
+        char ch = token();
+        switch (ch)
+        {
+        case '{':
+            return parseObject(out);
+        case '[':
+            return parseArray(out);
+        case '"':
+            return parseString(JsonFill::str(out));
+        case 'n':
+            return parseConstant("null", nullptr, out);
+        case 't':
+            return parseConstant("true", true, out);
+        case 'f':
+            return parseConstant("false", false, out);
+        }
+        if (ch == '+' || ch == '-' || isJsonDigit(ch))
+            return parseNumber(out);
+        return fail("Undefined token '" + string(1, ch) + "'.");
+    }
+
+    bool atEnd() const { return cur == index.size(); }
+    string getError() const { return err; }
+};
+
+// parse s with the structural index engine, the results match parseJson(s)
+inline ParseResult parseJsonIndexed(string_view s)
+{
+    JsonStructuralIndex index;
+    if (!index.build(s))
+        return ParseResult().setError(index.getError());
+    JsonIndexedBuilder builder(s, index);
+    Json res;
+    if (!builder.parseValue(res))
+        return ParseResult().setError(builder.getError());
+    if (!builder.atEnd())
+        return ParseResult().setError("Something went wrong!");
+    return ParseResult().setJson(std::move(res));
+}
+
+inline ParseResult readJsonIndexed(const string &filepath)
+{
+    JsonFileBuffer file(filepath);
+    if (!file.isOpen())
+        return ParseResult().setError("file " + filepath + " not found!");
+    return parseJsonIndexed(file.view());
+}
+
+#endif // JSON_INDEX_H
@@ -0,0 +1,294 @@
+/*
+    lazy json documents.
+
+    a LazyJsonDocument only builds the structural index of its input (see json_index.h)
+    and a table of matching brackets. values are decoded when they are accessed, and
+    whole subtrees that are not on the accessed path are jumped over in one step.
+
+    LazyJsonDocument doc;
+    if (doc.read("test/test2.json"))
+        cout << doc["web-app"]["servlet"][1]["servlet-name"].getString() << endl;
+*/
+
+#ifndef JSON_LAZY_H
+#define JSON_LAZY_H
+
+#include <algorithm>
+#include <memory>
+#include "json_index.h"
+
+class LazyJson;
+
+class LazyJsonDocument
+{
+private:
+    friend class LazyJson;
+
+    unique_ptr<JsonFileBuffer> file;
+    string_view src;
+    JsonStructuralIndex index;
+    vector<uint32_t> match; // token of the matching '}' or ']' for every '{' and '['
+    string err;
+
+    bool fail(string e)
+    {
+        err = e;
+        src = string_view();
+        return false;
+    }
+
+    // pair up the brackets so containers can be skipped without looking inside
+    bool matchBrackets()
+    {
+        match.assign(index.size(), 0);
+        vector<uint32_t> open;
+        for (size_t i = 0; i < index.size(); i++)
+        {
+            char ch = src[index[i]];
+            if (ch == '{' || ch == '[')
+                open.push_back(i);
+            else if (ch == '}' || ch == ']')
+            {
+                if (open.empty())
+                    return fail("Something went wrong!");
+                if (src[index[open.back()]] != (ch == '}' ? '{' : '['))
+                    return fail(src[index[open.back()]] == '{' ? "Expected '}'." : "Expected ']'.");
+                match[open.back()] = i;
+                open.pop_back();
+            }
+        }
+        if (!open.empty())
+            return fail(src[index[open.back()]] == '{' ? "Expected '}'." : "Expected ']'.");
+        return true;
+    }
+
+public:
+    LazyJsonDocument() = default;
+    LazyJsonDocument(const LazyJsonDocument &) = delete;
+    LazyJsonDocument &operator=(const LazyJsonDocument &) = delete;
+
+    // index s without decoding it. s is referenced, not copied, and has to outlive the document
+    bool parse(string_view s)
+    {
+        err.clear();
+        src = s;
+        if (!index.build(s))
+            return fail(index.getError());
+        if (index.endsInString())
+            return fail("Expected '\"'.");
+        if (index.size() == 0)
+            return fail("Undefined token '" + string(1, '\0') + "'.");
+        if (!matchBrackets())
+            return false;
+        char ch = src[index[0]];
+        size_t rootEnd = (ch == '{' || ch == '[') ? match[0] + 1 : 1;
+        if (rootEnd != index.size())
+            return fail("Something went wrong!");
+        return true;
+    }
+
+    // map the file and index it, the mapping is kept for the lifetime of the document
+    bool read(const string &filepath)
+    {
+        file.reset(new JsonFileBuffer(filepath));
+        if (!file->isOpen())
+            return fail("file " + filepath + " not found!");
+        return parse(file->view());
+    }
+
+    bool isError() const { return !err.empty(); }
+    string getError() const { return err; }
+
+    LazyJson root() const;
+    LazyJson operator[](size_t index) const;
+    LazyJson operator[](string_view key) const;
+};
+
+// a value of a LazyJsonDocument, decoded only when it is read.
+// mirrors the accessors of Json, but returns values instead of references
+class LazyJson
+{
+private:
+    const LazyJsonDocument *doc;
+    size_t tok; // token the value starts at
+
+    char tokenAt(size_t t) const { return t < doc->index.size() ? doc->src[doc->index[t]] : 0; }
+    char ch() const { return tokenAt(tok); }
+    const char *start() const { return doc->src.data() + doc->index[tok]; }
+    const char *srcEnd() const { return doc->src.data() + doc->src.size(); }
+
+    // the token right after the value starting at t
+    size_t skip(size_t t) const
+    {
+        char c = tokenAt(t);
+        return (c == '{' || c == '[') ? doc->match[t] + 1 : t + 1;
+    }
+
+    // the token after a member or element ending at t, or 0 at the end of the container
+    size_t nextItem(size_t t) const
+    {
+        if (tokenAt(t) != ',')
+            return 0;
+        char c = tokenAt(t + 1);
+        return (c == '}' || c == ']') ? 0 : t + 1;
+    }
+
+    bool keyEquals(size_t t, string_view key) const
+    {
+        const char *first = doc->src.data() + doc->index[t] + 1;
+        const char *p = findJsonStringSpecial(first, srcEnd());
+        if (p != srcEnd() && *p == '"') // no escapes, compare the raw bytes
+            return size_t(p - first) == key.size() && memcmp(first, key.data(), key.size()) == 0;
+        return LazyJson(doc, t).getString() == key;
+    }
+
+    // token of the value of key, 0 if there is none
+    size_t findMember(string_view key) const
+    {
+        size_t found = 0;
+        for (size_t t = ch() == '{' && tokenAt(tok + 1) == '"' ? tok + 1 : 0; t != 0;)
+        {
+            if (tokenAt(t) != '"' || tokenAt(t + 1) != ':')
+                throw "Error: malformed json!";
+            if (keyEquals(t, key))
+                found = t + 2; // the last repeated key wins, as in parseJson
+            t = nextItem(skip(t + 2));
+        }
+        return found;
+    }
+
+    Json number() const
+    {
+        Json num;
+        if (parseJsonNumber(start(), srcEnd(), num) == nullptr)
+            throw "Error: malformed json!";
+        return num;
+    }
+
+public:
+    LazyJson(const LazyJsonDocument *doc, size_t tok) : doc(doc), tok(tok) {}
+
+    // Type functions
+    Json::JsonType getType() const
+    {
+        switch (ch())
+        {
+        case '{':
+            return Json::JsonType::JT_OBJECT;
+        case '[':
+            return Json::JsonType::JT_ARRAY;
+        case '"':
+            return Json::JsonType::JT_STRING;
+        case 't':
+        case 'f':
+            return Json::JsonType::JT_BOOL;
+        case 'n':
+            return Json::JsonType::JT_NULL;
+        }
+        return number().getType();
+    }
+    bool isNull() const { return ch() == 'n'; }
+    bool isBool() const { return ch() == 't' || ch() == 'f'; }
+    bool isInt() const { return getType() == Json::JsonType::JT_INT; }
+    bool isInt64() const { return getType() == Json::JsonType::JT_INT64; }
+    bool isUInt64() const { return getType() == Json::JsonType::JT_UINT64; }
+    bool isDouble() const { return getType() == Json::JsonType::JT_DOUBLE; }
+    bool isString() const { return ch() == '"'; }
+    bool isArray() const { return ch() == '['; }
+    bool isObject() const { return ch() == '{'; }
+
+    // get values
+    bool getBool() const
+    {
+        if (!isBool())
+            throw "Error: not-bool!";
+        return ch() == 't';
+    }
+    int getInt() const { return number().getInt(); }
+    int64_t getInt64() const { return number().getInt64(); }
+    uint64_t getUInt64() const { return number().getUInt64(); }
+    double getDouble() const { return number().getDouble(); }
+    string getString() const
+    {
+        if (!isString())
+            throw "Error: not-String!";
+        const char *first = start() + 1;
+        const char *close = scanJsonString(first, srcEnd());
+        string res(close - first, '\0');
+        res.resize(unescapeJsonString(first, close, &res[0]) - res.data());
+        return res;
+    }
+
+    // size function
+
+    size_t size() const
+    {
+        if (!isArray() && !isObject())
+            return -1;
+        size_t n = 0;
+        if (isArray())
+        {
+            for (size_t t = tokenAt(tok + 1) == ']' ? 0 : tok + 1; t != 0; n++)
+                t = nextItem(skip(t));
+            return n;
+        }
+        // a repeated key is one member, as in parseJson
+        vector<string> keys;
+        for (size_t t = tokenAt(tok + 1) == '}' ? 0 : tok + 1; t != 0; t = nextItem(skip(t + 2)))
+            keys.push_back(LazyJson(doc, t).getString());
+        sort(keys.begin(), keys.end());
+        return unique(keys.begin(), keys.end()) - keys.begin();
+    }
+
+    // access operators
+
+    LazyJson operator[](size_t index) const
+    {
+        if (!isArray())
+            throw "Error: Not an json array!";
+        size_t t = tokenAt(tok + 1) == ']' ? 0 : tok + 1;
+        for (; t != 0 && index > 0; index--)
+            t = nextItem(skip(t));
+        if (t == 0)
+            throw "Error: out-of-bound error!";
+        return LazyJson(doc, t);
+    }
+
+    LazyJson operator[](string_view key) const
+    {
+        if (!isObject())
+            throw "Error: Not an json object!";
+        size_t t = findMember(key);
+        if (t == 0)
+            throw "Error: key not found!";
+        return LazyJson(doc, t);
+    }
+
+    LazyJson at(size_t index) const { return operator[](index); }
+    LazyJson at(string_view key) const { return operator[](key); }
+
+    bool contains(string_view key) const { return isObject() && findMember(key) != 0; }
+
+    // decode this value and everything below it
+    Json toJson() const
+    {
+        JsonIndexedBuilder builder(doc->src, doc->index, tok);
+        Json res;
+        if (!builder.parseValue(res))
+            throw "Error: malformed json!";
+        return res;
+    }
+
+    string dump(int depth = 1, string tabStyle = "    ") const { return toJson().dump(depth, tabStyle); }
+};
+
+inline LazyJson LazyJsonDocument::root() const
+{
+    if (src.empty())
+        throw "Error: empty document!";
+    return LazyJson(this, 0);
+}
+inline LazyJson LazyJsonDocument::operator[](size_t index) const { return root()[index]; }
+inline LazyJson LazyJsonDocument::operator[](string_view key) const { return root()[key]; }
+
+#endif // JSON_LAZY_H
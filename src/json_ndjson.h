@@ -0,0 +1,281 @@
+/*
+    newline delimited json (ndjson, json lines).
+
+    a JsonLinesReader reads the input in large blocks, cuts them at line ends and parses
+    the records of each block on a pool of worker threads. records are handed to the
+    callback on the calling thread, in input order or as soon as they are parsed.
+    only a fixed number of blocks is in memory at any time, whatever the size of the input.
+
+    JsonLinesReader reader([](size_t line, ParseResult &res) {
+        if (res.isError())
+            cout << line << ": " << res.getError() << endl;
+        return true; // false stops reading
+    });
+    if (!reader.read("log.ndjson"))
+        cout << reader.getError() << endl;
+*/
+
+#ifndef JSON_NDJSON_H
+#define JSON_NDJSON_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <deque>
+#include <cstring>
+#include <algorithm>
+#include "json.h"
+
+class JsonLinesReader
+{
+public:
+    // called with the 1-based line number and the parse result of every non-blank line.
+    // returning false stops reading
+    typedef function<bool(size_t, ParseResult &)> Callback;
+
+private:
+    // a run of whole lines and, once parsed, their records
+    struct Block
+    {
+        size_t seq;
+        size_t firstLine;
+        string text;
+        vector<pair<size_t, ParseResult>> records;
+    };
+
+    Callback callback;
+    size_t threads;
+    bool ordered;
+    size_t blockSize;
+    size_t maxBlocks; // blocks read but not yet delivered
+
+    mutex lock;
+    condition_variable workAvailable;
+    condition_variable workDone;
+    deque<unique_ptr<Block>> todo;
+    map<size_t, unique_ptr<Block>> parsed;
+    bool finished = false; // no more blocks will be queued
+    size_t records = 0;
+    string err;
+
+    static void parseBlock(JsonParser &parser, Block &block)
+    {
+        const char *p = block.text.data(), *end = p + block.text.size();
+        for (size_t line = block.firstLine; p != end; line++)
+        {
+            const char *eol = static_cast<const char *>(memchr(p, '\n', end - p));
+            if (eol == nullptr)
+                eol = end;
+            if (skipJsonWhitespace(p, eol) != eol) // blank lines are no records
+                block.records.emplace_back(line, parser.parse(string_view(p, eol - p)));
+            p = eol == end ? end : eol + 1;
+        }
+    }
+
+    void work()
+    {
+        JsonParser parser; // reused for every record this worker parses
+        while (true)
+        {
+            unique_ptr<Block> block;
+            {
+                unique_lock<mutex> guard(lock);
+                workAvailable.wait(guard, [this] { return !todo.empty() || finished; });
+                if (todo.empty())
+                    return;
+                block = std::move(todo.front());
+                todo.pop_front();
+            }
+            parseBlock(parser, *block);
+            {
+                lock_guard<mutex> guard(lock);
+                size_t seq = block->seq;
+                parsed[seq] = std::move(block);
+            }
+            workDone.notify_one();
+        }
+    }
+
+    // fill buf with the next block of whole lines from in, keeping a cut off line in carry.
+    // returns false when the input is exhausted
+    bool readBlock(istream &in, string &carry, string &buf)
+    {
+        buf.swap(carry);
+        carry.clear();
+        while (in)
+        {
+            size_t old = buf.size();
+            buf.resize(old + blockSize);
+            in.read(&buf[old], blockSize);
+            buf.resize(old + in.gcount());
+            // only the bytes just read can hold a newline, a long line is not searched again
+            size_t eol = string_view(buf).substr(old).rfind('\n');
+            if (eol != string::npos)
+            {
+                carry.assign(buf, old + eol + 1, string::npos);
+                buf.resize(old + eol + 1);
+                return true;
+            }
+        }
+        return !buf.empty(); // the last line has no newline
+    }
+
+    // the next block that may be handed to the callback, waits for it if needed
+    unique_ptr<Block> nextParsed(size_t seq)
+    {
+        unique_lock<mutex> guard(lock);
+        auto ready = [&] { return ordered ? parsed.count(seq) != 0 : !parsed.empty(); };
+        workDone.wait(guard, ready);
+        auto it = ordered ? parsed.find(seq) : parsed.begin();
+        unique_ptr<Block> block = std::move(it->second);
+        parsed.erase(it);
+        return block;
+    }
+
+    // hand the records of a block to the callback, returns false if it asked to stop
+    bool deliver(Block &block)
+    {
+        for (auto &record : block.records)
+        {
+            records++;
+            if (!callback(record.first, record.second))
+                return false;
+        }
+        return true;
+    }
+
+    // a single worker would only add hand-offs between threads, parse on this one instead
+    void readSerial(istream &in)
+    {
+        JsonParser parser;
+        Block block;
+        string carry;
+        block.firstLine = 1;
+        while (readBlock(in, carry, block.text))
+        {
+            block.records.clear();
+            parseBlock(parser, block);
+            if (!deliver(block))
+                return;
+            block.firstLine += count(block.text.begin(), block.text.end(), '\n');
+        }
+    }
+
+    // false if in failed, with err set
+    bool checkInput(istream &in)
+    {
+        if (in.bad())
+        {
+            err = "Error: failed to read the input!";
+            return false;
+        }
+        return true;
+    }
+
+    void stopWorkers(vector<thread> &pool)
+    {
+        {
+            lock_guard<mutex> guard(lock);
+            finished = true;
+            todo.clear();
+        }
+        workAvailable.notify_all();
+        for (auto &t : pool)
+            t.join();
+        parsed.clear();
+    }
+
+public:
+    // threads = 0 uses one worker per hardware thread.
+    // with ordered = false records are delivered in the order their blocks finish parsing.
+    // blocks are kept small so that the trees of a block are still in cache when delivered
+    JsonLinesReader(Callback callback, size_t threads = 0, bool ordered = true, size_t blockSize = 1 << 16)
+        : callback(callback), threads(threads), ordered(ordered), blockSize(blockSize)
+    {
+        if (this->threads == 0)
+            this->threads = max(1u, thread::hardware_concurrency());
+        if (this->blockSize == 0)
+            this->blockSize = 1;
+        maxBlocks = 2 * this->threads;
+    }
+
+    JsonLinesReader(const JsonLinesReader &) = delete;
+    JsonLinesReader &operator=(const JsonLinesReader &) = delete;
+
+    // read every record of in. returns false if the input could not be read;
+    // records that are not valid json are reported to the callback, not here
+    bool read(istream &in)
+    {
+        err.clear();
+        records = 0;
+        finished = false;
+        if (threads == 1)
+        {
+            readSerial(in);
+            return checkInput(in);
+        }
+        vector<thread> pool;
+        for (size_t i = 0; i < threads; i++)
+            pool.emplace_back(&JsonLinesReader::work, this);
+
+        string carry;
+        size_t line = 1, queued = 0, delivered = 0;
+        bool more = true, stopped = false;
+        try
+        {
+            while (!stopped && (more || delivered < queued))
+            {
+                if (more && queued - delivered < maxBlocks)
+                {
+                    unique_ptr<Block> block(new Block());
+                    more = readBlock(in, carry, block->text);
+                    if (!more)
+                        continue;
+                    block->seq = queued++;
+                    block->firstLine = line;
+                    line += count(block->text.begin(), block->text.end(), '\n');
+                    {
+                        lock_guard<mutex> guard(lock);
+                        todo.push_back(std::move(block));
+                    }
+                    workAvailable.notify_one();
+                    continue;
+                }
+                unique_ptr<Block> block = nextParsed(delivered);
+                delivered++;
+                stopped = !deliver(*block);
+            }
+        }
+        catch (...)
+        {
+            stopWorkers(pool);
+            throw;
+        }
+        stopWorkers(pool);
+        return checkInput(in);
+    }
+
+    bool read(const string &filepath)
+    {
+        ifstream fin(filepath, ios::binary);
+        if (!fin)
+        {
+            err = "file " + filepath + " not found!";
+            return false;
+        }
+        return read(fin);
+    }
+
+    string getError() const { return err; }
+    // records handed to the callback by the last read()
+    size_t recordCount() const { return records; }
+};
+
+// call back with every record of an ndjson file, parsed on all hardware threads in input order
+inline bool readJsonLines(const string &filepath, JsonLinesReader::Callback callback)
+{
+    return JsonLinesReader(callback).read(filepath);
+}
+
+#endif // JSON_NDJSON_H
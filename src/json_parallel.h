@@ -0,0 +1,226 @@
+/*
+    parallel parsing of one large json array.
+
+    the text is cut into one chunk per thread at commas that look like they separate
+    elements of the top-level array, and every chunk is parsed on its own thread.
+    the guesses are checked while the chunks are put together: a chunk is only used if
+    the chunk before it ended exactly where it starts, otherwise that part of the array
+    is parsed again sequentially. the results always match parseJson().
+
+    auto res = readJsonParallel("feed.json");
+*/
+
+#ifndef JSON_PARALLEL_H
+#define JSON_PARALLEL_H
+
+#include <thread>
+#include "json.h"
+
+class JsonParallelParser
+{
+private:
+    // a run of array elements parsed on its own
+    struct Chunk
+    {
+        size_t begin;     // where the first element starts, right after a ','
+        size_t end;       // the chunk runs until it has read past this point
+        size_t stop = 0;  // right after the last ',' read, or at the closing ']'
+        bool closed = false; // the closing ']' was reached
+        bool ok = false;
+        vector<Json> items;
+    };
+
+    string_view src;
+    size_t threads;
+    size_t minSize;
+    size_t kept = 0;
+
+    // where the element list of the top-level array starts, 0 if s is no array
+    size_t arrayStart() const
+    {
+        const char *p = skipJsonWhitespace(src.data(), src.data() + src.size());
+        if (p == src.data() + src.size() || *p != '[')
+            return 0;
+        return p + 1 - src.data();
+    }
+
+    // the value starting at p is an object key, a string followed by ':'
+    bool isKey(size_t p) const
+    {
+        if (src[p] != '"')
+            return false;
+        const char *close = scanJsonString(src.data() + p + 1, src.data() + src.size());
+        size_t next = src.find_first_not_of(" \t\r\n", close + 1 - src.data());
+        return next != string_view::npos && src[next] == ':';
+    }
+
+    // a ',' in [pos, limit) that separates two records, },{ or ],[ which is rare inside strings,
+    // or with records false any ',' before a value that is no object key.
+    // returns the position after it or npos
+    size_t findSplit(size_t pos, size_t limit, bool records) const
+    {
+        for (; pos < limit; pos++)
+        {
+            pos = src.find(',', pos);
+            if (pos == string_view::npos || pos >= limit)
+                return string_view::npos;
+            size_t prev = src.find_last_not_of(" \t\r\n", pos - 1);
+            size_t next = src.find_first_not_of(" \t\r\n", pos + 1);
+            if (prev == string_view::npos || next == string_view::npos)
+                continue;
+            char ch = src[next];
+            if (records ? (src[prev] == '}' && ch == '{') || (src[prev] == ']' && ch == '[')
+                        : (ch == '"' || ch == '-' || isJsonDigit(ch) || ch == 't' || ch == 'f' || ch == 'n' ||
+                           ch == '{' || ch == '[') && !isKey(next))
+                return pos + 1;
+        }
+        return string_view::npos;
+    }
+
+    // a ',' at or after pos that likely separates two elements of the top-level array,
+    // returns the position after it or npos. records are looked for nearby first, arrays
+    // of numbers or strings have none and are split before any value
+    size_t guessSplit(size_t pos, size_t limit) const
+    {
+        size_t split = findSplit(pos, min(limit, pos + (1 << 16)), true);
+        return split != string_view::npos ? split : findSplit(pos, limit, false);
+    }
+
+    // parse elements from begin until a ',' at or past until has been read, or the array closes
+    static void parseRun(string_view src, Chunk &chunk, size_t begin, size_t until)
+    {
+        JsonDomBuilder builder;
+        JsonEventParser<JsonDomBuilder> parser;
+        const char *last = src.data() + src.size();
+        size_t p = begin;
+        chunk.ok = false;
+        chunk.closed = false;
+        while (p < until)
+        {
+            p = skipJsonWhitespace(src.data() + p, last) - src.data();
+            if (p < src.size() && src[p] == ']')
+            {
+                chunk.closed = true; // an empty array or a trailing ',', as parseArray accepts
+                break;
+            }
+            builder.reset();
+            size_t n = parser.parsePrefix(src.substr(p), builder);
+            if (n == 0)
+                return;
+            chunk.items.push_back(std::move(builder.getJson()));
+            p = skipJsonWhitespace(src.data() + p + n, last) - src.data();
+            if (p == src.size())
+                return;
+            if (src[p] == ']')
+            {
+                chunk.closed = true;
+                break;
+            }
+            if (src[p] != ',')
+                return;
+            p++;
+        }
+        chunk.stop = p;
+        chunk.ok = true;
+    }
+
+public:
+    // threads = 0 uses one thread per hardware thread.
+    // inputs smaller than minSize, or not an array, are parsed sequentially
+    JsonParallelParser(size_t threads = 0, size_t minSize = 1 << 20) : threads(threads), minSize(minSize)
+    {
+        if (this->threads == 0)
+            this->threads = max(1u, thread::hardware_concurrency());
+    }
+
+    ParseResult parse(string_view s)
+    {
+        src = s;
+        kept = 0;
+        size_t start = arrayStart();
+        if (start == 0 || threads < 2 || s.size() < minSize)
+            return parseJson(s);
+
+        // guess where the chunks start
+        vector<Chunk> chunks(1);
+        chunks[0].begin = start;
+        for (size_t i = 1; i < threads; i++)
+        {
+            size_t split = guessSplit(max(chunks.back().begin, s.size() / threads * i), s.size());
+            if (split == string_view::npos)
+                break;
+            if (split == chunks.back().begin)
+                continue;
+            chunks.emplace_back();
+            chunks.back().begin = split;
+        }
+        for (size_t i = 0; i < chunks.size(); i++)
+            chunks[i].end = i + 1 < chunks.size() ? chunks[i + 1].begin : string_view::npos;
+
+        vector<thread> pool;
+        for (size_t i = 1; i < chunks.size(); i++)
+            pool.emplace_back(parseRun, s, ref(chunks[i]), chunks[i].begin, chunks[i].end);
+        parseRun(s, chunks[0], chunks[0].begin, chunks[0].end);
+        for (auto &t : pool)
+            t.join();
+
+        // stitch the chunks whose start is confirmed by the chunk before them
+        Json res;
+        vector<Json> &arr = JsonFill::arr(res);
+        size_t items = 0;
+        for (auto &chunk : chunks)
+            items += chunk.items.size();
+        arr.reserve(items);
+        size_t pos = start, used = 0;
+        bool closed = false;
+        for (size_t i = 0; i < chunks.size() && !closed; i++)
+        {
+            Chunk &chunk = chunks[i];
+            if (pos >= chunk.end)
+                continue; // already covered by an earlier chunk that ran long
+            if (pos != chunk.begin || !chunk.ok)
+            {
+                // wrong guess, parse this part again from where the array really is
+                Chunk redo;
+                redo.begin = pos;
+                parseRun(s, redo, pos, chunk.end);
+                if (!redo.ok)
+                    return parseJson(s); // invalid input, report it the way parseJson does
+                chunk = std::move(redo);
+            }
+            else
+                used++;
+            for (auto &item : chunk.items)
+                arr.push_back(std::move(item));
+            pos = chunk.stop;
+            closed = chunk.closed;
+        }
+        if (!closed)
+            return parseJson(s);
+        const char *p = skipJsonWhitespace(s.data() + pos + 1, s.data() + s.size());
+        if (p != s.data() + s.size())
+            return ParseResult().setError("Something went wrong!");
+        kept = used;
+        return ParseResult().setJson(std::move(res));
+    }
+
+    // the chunks of the last parse that started where they were guessed to, so were
+    // parsed on their own thread and kept. 0 if it was parsed sequentially
+    size_t keptChunks() const { return kept; }
+};
+
+// parse s, splitting a large top-level array across all hardware threads
+inline ParseResult parseJsonParallel(string_view s, size_t threads = 0)
+{
+    return JsonParallelParser(threads).parse(s);
+}
+
+inline ParseResult readJsonParallel(const string &filepath, size_t threads = 0)
+{
+    JsonFileBuffer file(filepath);
+    if (!file.isOpen())
+        return ParseResult().setError("file " + filepath + " not found!");
+    return parseJsonParallel(file.view(), threads);
+}
+
+#endif // JSON_PARALLEL_H
@@ -0,0 +1,748 @@
+/*
+    json queries.
+
+    a JsonPointer (RFC 6901) addresses a single value, a JsonPath selects any number of them.
+    both are compiled once, keys are unescaped and indices converted at that point, so
+    running a query only walks the tree: no key is copied and nothing is allocated when
+    the selected values are collected into a vector that is reused.
+
+    JsonPointer servletName("/web-app/servlet/1/servlet-name");
+    const Json *name = servletName.find(json); // nullptr if it is missing
+
+    JsonPath templates("$['web-app'].servlet[?(@.init-param.useJSP == false)]..templatePath");
+    vector<const Json *> found;
+    templates.select(json, found);
+
+    supported JsonPath syntax:
+        $                   the root
+        .name ['name']      a member
+        [2] [-1]            an element, negative indices count from the end
+        .* [*]              every member or element
+        ..name ..* ..[0]    the same, applied at every depth below
+        [?(@.a.b)]          elements or members that have a value at a relative path
+        [?(@.a op literal)] ... whose value compares to a number, string, true, false or null
+                            with ==, !=, <, <=, > or >=
+*/
+
+#ifndef JSON_QUERY_H
+#define JSON_QUERY_H
+
+#include <cstring>
+#include "json.h"
+
+// ========== json pointer
+
+class JsonPointer
+{
+private:
+    struct Token
+    {
+        string key;
+        size_t index; // the key as an array index, npos if it is none
+    };
+
+    vector<Token> tokens;
+
+    static size_t toIndex(string_view key)
+    {
+        // "0" or digits without a leading zero, "-" (past the end) is never found
+        if (key.empty() || key.size() > 18 || (key.size() > 1 && key[0] == '0'))
+            return string::npos;
+        size_t n = 0;
+        for (char c : key)
+        {
+            if (!isJsonDigit(c))
+                return string::npos;
+            n = n * 10 + (c - '0');
+        }
+        return n;
+    }
+
+    template <class J>
+    static J *walk(J &root, const vector<Token> &tokens)
+    {
+        J *cur = &root;
+        for (const Token &token : tokens)
+        {
+            if (cur->isObject())
+            {
+                auto &members = cur->getObject();
+                auto it = members.find(string_view(token.key));
+                if (it == members.end())
+                    return nullptr;
+                cur = &it->second;
+            }
+            else if (cur->isArray())
+            {
+                auto &elems = cur->getArray();
+                if (token.index >= elems.size())
+                    return nullptr;
+                cur = &elems[token.index];
+            }
+            else
+                return nullptr;
+        }
+        return cur;
+    }
+
+public:
+    // "" is the whole document, every other pointer starts with '/'
+    explicit JsonPointer(string_view pointer)
+    {
+        if (pointer.empty())
+            return;
+        if (pointer[0] != '/')
+            throw "Error: invalid json pointer!";
+        size_t pos = 1;
+        while (true)
+        {
+            size_t end = pointer.find('/', pos);
+            if (end == string_view::npos)
+                end = pointer.size();
+            Token token;
+            for (size_t i = pos; i < end; i++)
+            {
+                if (pointer[i] != '~')
+                {
+                    token.key += pointer[i];
+                    continue;
+                }
+                if (i + 1 == end || (pointer[i + 1] != '0' && pointer[i + 1] != '1'))
+                    throw "Error: invalid json pointer!";
+                token.key += pointer[++i] == '0' ? '~' : '/';
+            }
+            token.index = toIndex(token.key);
+            tokens.push_back(std::move(token));
+            if (end == pointer.size())
+                break;
+            pos = end + 1;
+        }
+    }
+
+    // the value the pointer refers to, nullptr if there is none
+    const Json *find(const Json &root) const { return walk(root, tokens); }
+    Json *find(Json &root) const { return walk(root, tokens); }
+
+    // like find(), but throws if the value is missing
+    const Json &at(const Json &root) const
+    {
+        const Json *res = find(root);
+        if (res == nullptr)
+            throw "Error: key not found!";
+        return *res;
+    }
+
+    size_t size() const { return tokens.size(); }
+};
+
+// ========== json path
+
+class JsonPath
+{
+private:
+    enum class StepType
+    {
+        KEY,
+        INDEX,
+        WILDCARD,
+        FILTER,
+    };
+
+    enum class CompareOp
+    {
+        EXISTS,
+        EQ,
+        NE,
+        LT,
+        LE,
+        GT,
+        GE,
+    };
+
+    struct Step
+    {
+        StepType type;
+        bool recursive = false; // applied to the value and everything below it (..)
+        string key;
+        long long index = 0;
+        // filters: [?(@.path op literal)]
+        vector<Step> path;
+        CompareOp op = CompareOp::EXISTS;
+        Json literal;
+    };
+
+    // where the selected values go
+    struct Sink
+    {
+        vector<const Json *> *out;
+        const Json *first = nullptr;
+        size_t count = 0;
+        size_t limit;
+
+        bool full() const { return count >= limit; }
+        void add(const Json *json)
+        {
+            if (count++ == 0)
+                first = json;
+            if (out)
+                out->push_back(json);
+        }
+    };
+
+    vector<Step> steps;
+    string_view text;
+    size_t pos = 0;
+
+    // ========== compiling
+
+    [[noreturn]] void fail() const { throw "Error: invalid json path!"; }
+
+    bool isEnd() const { return pos >= text.size(); }
+    char peek() const { return isEnd() ? '\0' : text[pos]; }
+    void expect(char c)
+    {
+        if (peek() != c)
+            fail();
+        pos++;
+    }
+    void skipSpace()
+    {
+        while (!isEnd() && isJsonSpace(text[pos]))
+            pos++;
+    }
+
+    // a dotted member name runs until the next '.', '[' or the end of a filter
+    string parseName()
+    {
+        size_t start = pos;
+        while (!isEnd() && peek() != '.' && peek() != '[' && peek() != ')' && peek() != ']' &&
+               !isJsonSpace(peek()) && string_view("=!<>").find(peek()) == string_view::npos)
+            pos++;
+        if (pos == start)
+            fail();
+        return string(text.substr(start, pos - start));
+    }
+
+    string parseQuoted()
+    {
+        char quote = peek();
+        pos++;
+        string res;
+        while (!isEnd() && peek() != quote)
+        {
+            if (peek() == '\\' && pos + 1 < text.size())
+                pos++;
+            res += text[pos++];
+        }
+        expect(quote);
+        return res;
+    }
+
+    long long parseInteger()
+    {
+        long long n = 0;
+        const char *first = text.data() + pos, *last = text.data() + text.size();
+        auto res = from_chars(first, last, n);
+        if (res.ec != errc() || res.ptr == first)
+            fail();
+        pos += res.ptr - first;
+        return n;
+    }
+
+    Json parseLiteral()
+    {
+        if (peek() == '\'' || peek() == '"')
+            return Json(parseQuoted());
+        for (const char *name : {"true", "false", "null"})
+        {
+            if (text.compare(pos, strlen(name), name) == 0)
+            {
+                pos += strlen(name);
+                return name[0] == 'n' ? Json() : Json(name[0] == 't');
+            }
+        }
+        Json num;
+        const char *end = parseJsonNumber(text.data() + pos, text.data() + text.size(), num);
+        if (end == nullptr)
+            fail();
+        pos = end - text.data();
+        return num;
+    }
+
+    CompareOp parseOp()
+    {
+        static const pair<const char *, CompareOp> ops[] = {
+            {"==", CompareOp::EQ}, {"!=", CompareOp::NE}, {"<=", CompareOp::LE},
+            {">=", CompareOp::GE}, {"<", CompareOp::LT}, {">", CompareOp::GT}};
+        for (const auto &op : ops)
+        {
+            if (text.compare(pos, strlen(op.first), op.first) == 0)
+            {
+                pos += strlen(op.first);
+                return op.second;
+            }
+        }
+        return CompareOp::EXISTS;
+    }
+
+    // [?(@.path op literal)], pos is at '?'
+    Step parseFilter()
+    {
+        Step step;
+        step.type = StepType::FILTER;
+        expect('?');
+        expect('(');
+        skipSpace();
+        expect('@');
+        while (peek() == '.' || peek() == '[')
+        {
+            Step sub = parseSelector(false);
+            if (sub.type != StepType::KEY && sub.type != StepType::INDEX)
+                fail();
+            step.path.push_back(std::move(sub));
+        }
+        skipSpace();
+        step.op = parseOp();
+        if (step.op != CompareOp::EXISTS)
+        {
+            skipSpace();
+            step.literal = parseLiteral();
+            skipSpace();
+        }
+        expect(')');
+        return step;
+    }
+
+    // [...], pos is at '['
+    Step parseBracket(bool allowFilter)
+    {
+        Step step;
+        expect('[');
+        skipSpace();
+        if (peek() == '*')
+        {
+            pos++;
+            step.type = StepType::WILDCARD;
+        }
+        else if (peek() == '\'' || peek() == '"')
+        {
+            step.type = StepType::KEY;
+            step.key = parseQuoted();
+        }
+        else if (peek() == '?' && allowFilter)
+            step = parseFilter();
+        else
+        {
+            step.type = StepType::INDEX;
+            step.index = parseInteger();
+        }
+        skipSpace();
+        expect(']');
+        return step;
+    }
+
+    // one .name, .*, ..name or [...] selector. inside filters only plain members and indices are allowed
+    Step parseSelector(bool topLevel)
+    {
+        if (peek() == '[')
+            return parseBracket(topLevel);
+        expect('.');
+        bool recursive = false;
+        if (peek() == '.')
+        {
+            if (!topLevel)
+                fail();
+            pos++;
+            recursive = true;
+        }
+        Step step;
+        if (peek() == '[' && recursive)
+            step = parseBracket(true);
+        else if (peek() == '*')
+        {
+            pos++;
+            step.type = StepType::WILDCARD;
+        }
+        else
+        {
+            step.type = StepType::KEY;
+            step.key = parseName();
+        }
+        step.recursive = recursive;
+        return step;
+    }
+
+    // ========== evaluation
+
+    static bool toNumber(const Json &json, double &d)
+    {
+        switch (json.getType())
+        {
+        case Json::JsonType::JT_INT:
+            d = json.getInt();
+            return true;
+        case Json::JsonType::JT_INT64:
+            d = json.getInt64();
+            return true;
+        case Json::JsonType::JT_UINT64:
+            d = json.getUInt64();
+            return true;
+        case Json::JsonType::JT_DOUBLE:
+            d = json.getDouble();
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // values of different types are only ever unequal
+    static bool compare(const Json &value, CompareOp op, const Json &literal)
+    {
+        int cmp;
+        double a, b;
+        if (toNumber(value, a) && toNumber(literal, b))
+            cmp = a < b ? -1 : a > b ? 1 : 0;
+        else if (value.isString() && literal.isString())
+            cmp = value.getString().compare(literal.getString());
+        else if (value.isBool() && literal.isBool())
+            cmp = int(value.getBool()) - int(literal.getBool());
+        else if (value.isNull() && literal.isNull())
+            cmp = 0;
+        else
+            return op == CompareOp::NE;
+        switch (op)
+        {
+        case CompareOp::EQ:
+            return cmp == 0;
+        case CompareOp::NE:
+            return cmp != 0;
+        case CompareOp::LT:
+            return cmp < 0;
+        case CompareOp::LE:
+            return cmp <= 0;
+        case CompareOp::GT:
+            return cmp > 0;
+        case CompareOp::GE:
+            return cmp >= 0;
+        default:
+            return true;
+        }
+    }
+
+    static const Json *child(const Json &json, const Step &step)
+    {
+        if (step.type == StepType::KEY)
+        {
+            if (!json.isObject())
+                return nullptr;
+            auto it = json.getObject().find(string_view(step.key));
+            return it == json.getObject().end() ? nullptr : &it->second;
+        }
+        if (!json.isArray())
+            return nullptr;
+        const vector<Json> &elems = json.getArray();
+        long long i = step.index < 0 ? step.index + (long long)elems.size() : step.index;
+        return i >= 0 && i < (long long)elems.size() ? &elems[i] : nullptr;
+    }
+
+    static bool matches(const Json &json, const Step &filter)
+    {
+        const Json *cur = &json;
+        for (const Step &sub : filter.path)
+            if ((cur = child(*cur, sub)) == nullptr)
+                return false;
+        return filter.op == CompareOp::EXISTS || compare(*cur, filter.op, filter.literal);
+    }
+
+    // apply the selector of a step to one value, without recursion
+    void selectStep(size_t i, const Json &json, Sink &sink) const
+    {
+        const Step &step = steps[i];
+        switch (step.type)
+        {
+        case StepType::KEY:
+        case StepType::INDEX:
+            if (const Json *next = child(json, step))
+                run(i + 1, *next, sink);
+            break;
+        case StepType::WILDCARD:
+        case StepType::FILTER:
+            if (json.isArray())
+            {
+                for (const Json &elem : json.getArray())
+                    if (step.type == StepType::WILDCARD || matches(elem, step))
+                        run(i + 1, elem, sink);
+            }
+            else if (json.isObject())
+            {
+                for (const auto &member : json.getObject())
+                    if (step.type == StepType::WILDCARD || matches(member.second, step))
+                        run(i + 1, member.second, sink);
+            }
+            break;
+        }
+    }
+
+    // apply a step, and for .. also to every value below
+    void descend(size_t i, const Json &json, Sink &sink) const
+    {
+        if (sink.full())
+            return;
+        selectStep(i, json, sink);
+        if (json.isArray())
+            for (const Json &elem : json.getArray())
+                descend(i, elem, sink);
+        else if (json.isObject())
+            for (const auto &member : json.getObject())
+                descend(i, member.second, sink);
+    }
+
+    void run(size_t i, const Json &json, Sink &sink) const
+    {
+        if (sink.full())
+            return;
+        if (i == steps.size())
+            sink.add(&json);
+        else if (steps[i].recursive)
+            descend(i, json, sink);
+        else
+            selectStep(i, json, sink);
+    }
+
+public:
+    explicit JsonPath(string_view path) : text(path)
+    {
+        skipSpace();
+        expect('$');
+        while (!isEnd())
+            steps.push_back(parseSelector(true));
+        text = string_view();
+    }
+
+    // append every selected value to out, in document order
+    void select(const Json &root, vector<const Json *> &out) const
+    {
+        Sink sink{&out, nullptr, 0, SIZE_MAX};
+        run(0, root, sink);
+    }
+
+    vector<const Json *> select(const Json &root) const
+    {
+        vector<const Json *> out;
+        select(root, out);
+        return out;
+    }
+
+    // the first selected value, nullptr if there is none
+    const Json *first(const Json &root) const
+    {
+        Sink sink{nullptr, nullptr, 0, 1};
+        run(0, root, sink);
+        return sink.first;
+    }
+
+    // the number of selected values
+    size_t count(const Json &root) const
+    {
+        Sink sink{nullptr, nullptr, 0, SIZE_MAX};
+        run(0, root, sink);
+        return sink.count;
+    }
+};
+
+// ========== projection
+
+// parses only the parts of a document that lie on a set of paths. everything else is
+// skipped at the byte level without being decoded or allocated.
+// a skipped number, constant or string is still checked, but inside a skipped array or
+// object only the strings and the bracket nesting are: {"a":1,"b":[garbage]} projected
+// on /a gives {"a":1} where parseJson() fails.
+// paths are json pointers in which a "*" segment matches every element or member.
+// arrays keep only their selected elements, in document order
+class JsonProjection
+{
+private:
+    static const size_t none = SIZE_MAX;
+
+    // the paths as a tree, node 0 is the document
+    struct Node
+    {
+        map<string, size_t, less<>> children;
+        size_t any = none; // the child for "*"
+        bool all = false;  // the whole value is wanted
+    };
+
+    vector<Node> nodes;
+
+    size_t addChild(size_t n, const string &key)
+    {
+        if (key == "*")
+        {
+            if (nodes[n].any == none)
+            {
+                nodes[n].any = nodes.size();
+                nodes.emplace_back();
+            }
+            return nodes[n].any;
+        }
+        auto it = nodes[n].children.find(key);
+        if (it != nodes[n].children.end())
+            return it->second;
+        nodes.emplace_back();
+        nodes[n].children[key] = nodes.size() - 1;
+        return nodes.size() - 1;
+    }
+
+    void addPath(string_view path)
+    {
+        if (!path.empty() && path[0] != '/')
+            throw "Error: invalid json pointer!";
+        size_t n = 0;
+        for (size_t pos = 1; pos <= path.size() && !nodes[n].all;)
+        {
+            size_t end = min(path.find('/', pos), path.size());
+            string key;
+            for (size_t i = pos; i < end; i++)
+            {
+                if (path[i] != '~')
+                    key += path[i];
+                else if (i + 1 < end && (path[i + 1] == '0' || path[i + 1] == '1'))
+                    key += path[++i] == '0' ? '~' : '/';
+                else
+                    throw "Error: invalid json pointer!";
+            }
+            n = addChild(n, key);
+            pos = end + 1;
+        }
+        nodes[n].all = true;
+    }
+
+    // add everything src selects to dst
+    void graft(size_t dst, size_t src)
+    {
+        if (dst == src)
+            return;
+        nodes[dst].all = nodes[dst].all || nodes[src].all;
+        for (auto child : vector<pair<string, size_t>>(nodes[src].children.begin(), nodes[src].children.end()))
+            graft(addChild(dst, child.first), child.second);
+        if (nodes[src].any != none)
+            graft(addChild(dst, "*"), nodes[src].any);
+    }
+
+    // a key also matches "*", so every named child takes over what its "*" sibling selects
+    void mergeWildcards(size_t n)
+    {
+        if (nodes[n].any != none)
+            for (auto &child : vector<pair<string, size_t>>(nodes[n].children.begin(), nodes[n].children.end()))
+                graft(child.second, nodes[n].any);
+        for (auto &child : vector<pair<string, size_t>>(nodes[n].children.begin(), nodes[n].children.end()))
+            mergeWildcards(child.second);
+        if (nodes[n].any != none)
+            mergeWildcards(nodes[n].any);
+    }
+
+    // the tree node of a member or element of the value at node n
+    size_t child(size_t n, string_view key) const
+    {
+        if (nodes[n].all)
+            return n;
+        auto it = nodes[n].children.find(key);
+        if (it != nodes[n].children.end())
+            return it->second;
+        return nodes[n].any;
+    }
+
+    class Builder : public JsonDomBuilder
+    {
+    private:
+        const JsonProjection &projection;
+        vector<pair<size_t, size_t>> open; // tree node and next element index of each open container
+        vector<bool> isOpenArray;
+        size_t next = 0; // tree node of the value about to be read
+
+        bool wanted() const { return projection.nodes[next].all; }
+
+    public:
+        explicit Builder(const JsonProjection &projection) : projection(projection) {}
+
+        bool wantValue()
+        {
+            if (isOpenArray.back())
+            {
+                char buf[24];
+                size_t index = open.back().second++;
+                next = projection.child(open.back().first, string_view(buf, to_chars(buf, buf + sizeof(buf), index).ptr - buf));
+            }
+            return next != none;
+        }
+        bool onKey(string_view k)
+        {
+            next = projection.child(open.back().first, k);
+            return next == none || JsonDomBuilder::onKey(k);
+        }
+
+        // scalars are only kept where a whole value is wanted, not on the way to one
+        bool onNull() { return !wanted() || JsonDomBuilder::onNull(); }
+        bool onBool(bool b) { return !wanted() || JsonDomBuilder::onBool(b); }
+        bool onNumber(const Json &number) { return !wanted() || JsonDomBuilder::onNumber(number); }
+        bool onString(string_view str) { return !wanted() || JsonDomBuilder::onString(str); }
+
+        bool onStartArray()
+        {
+            open.emplace_back(next, 0);
+            isOpenArray.push_back(true);
+            return JsonDomBuilder::onStartArray();
+        }
+        bool onStartObject()
+        {
+            open.emplace_back(next, 0);
+            isOpenArray.push_back(false);
+            return JsonDomBuilder::onStartObject();
+        }
+        bool onEndArray()
+        {
+            open.pop_back();
+            isOpenArray.pop_back();
+            return JsonDomBuilder::onEndArray();
+        }
+        bool onEndObject()
+        {
+            open.pop_back();
+            isOpenArray.pop_back();
+            return JsonDomBuilder::onEndObject();
+        }
+
+        void reset()
+        {
+            JsonDomBuilder::reset();
+            open.clear();
+            isOpenArray.clear();
+            next = 0;
+        }
+    };
+
+    Builder builder{*this};
+    JsonEventParser<Builder> parser;
+
+public:
+    // "" selects the whole document, "/a/b" a member, "/items/*/id" the id of every element
+    explicit JsonProjection(const vector<string> &paths) : nodes(1)
+    {
+        for (const string &path : paths)
+            addPath(path);
+        mergeWildcards(0);
+    }
+
+    JsonProjection(const JsonProjection &) = delete;
+    JsonProjection &operator=(const JsonProjection &) = delete;
+
+    ParseResult parse(string_view s)
+    {
+        builder.reset();
+        if (!parser.parse(s, builder))
+            return ParseResult().setError(parser.getError());
+        return ParseResult().setJson(std::move(builder.getJson()));
+    }
+};
+
+#endif // JSON_QUERY_H
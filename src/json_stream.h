@@ -0,0 +1,313 @@
+/*
+    incremental json parsing.
+
+    a JsonPushParser is fed the input in chunks of any size, e.g. as they arrive from a
+    socket, and keeps its state between calls. only a token that is split across chunks
+    is buffered, never the whole document.
+
+    JsonPushParser parser;
+    ssize_t n;
+    while (!parser.done() && (n = recv(fd, buf, sizeof(buf), 0)) > 0)
+        if (!parser.feed(buf, n))
+            break;
+    parser.finish();
+    ParseResult res = parser.result();
+*/
+
+#ifndef JSON_STREAM_H
+#define JSON_STREAM_H
+
+#include "json.h"
+
+class JsonPushParser
+{
+private:
+    enum class State
+    {
+        VALUE,       // a value is expected
+        ARRAY_VALUE, // a value or ']' is expected
+        OBJECT_KEY,  // a key or '}' is expected
+        COLON,       // ':' is expected
+        AFTER_VALUE, // ',' or the end of the enclosing container is expected
+        STRING,      // inside a string
+        NUMBER,      // inside a number
+        LITERAL,     // inside null, true or false
+        DONE,        // the document is complete, only whitespace may follow
+        ERROR,
+    };
+
+    // a container that is still open
+    struct Frame
+    {
+        Json value;
+        string key; // key of the member being parsed
+    };
+
+    State state = State::VALUE;
+    vector<Frame> stack;
+    Json root;
+    string token;              // the part of a string, number or constant read so far
+    bool readingKey = false;   // the current string is an object key
+    bool escapePending = false; // the last chunk ended right after a '\' inside a string
+    string err;
+
+    bool fail(string e)
+    {
+        err = e;
+        state = State::ERROR;
+        return false;
+    }
+
+    static bool isNumberChar(char c) { return isJsonDigit(c) || c == '+' || c == '-' || c == '.' || c == 'e' || c == 'E'; }
+    static bool isLiteralChar(char c) { return isalnum((unsigned char)c) || c == '_'; }
+
+    // hand a finished value to the enclosing container, or make it the document
+    void emit(Json &&value)
+    {
+        if (stack.empty())
+        {
+            root = std::move(value);
+            state = State::DONE;
+            return;
+        }
+        Frame &top = stack.back();
+        if (top.value.isArray())
+            JsonFill::arr(top.value).push_back(std::move(value));
+        else
+            JsonFill::obj(top.value)[top.key] = std::move(value);
+        state = State::AFTER_VALUE;
+    }
+
+    void open(Json::JsonType type)
+    {
+        stack.emplace_back();
+        stack.back().value.setType(type);
+        state = type == Json::JsonType::JT_ARRAY ? State::ARRAY_VALUE : State::OBJECT_KEY;
+    }
+
+    void close()
+    {
+        Json value = std::move(stack.back().value);
+        stack.pop_back();
+        emit(std::move(value));
+    }
+
+    // read string contents up to the closing quote, returns where reading stopped
+    const char *continueString(const char *p, const char *end)
+    {
+        if (escapePending)
+        {
+            token += *p++;
+            escapePending = false;
+        }
+        while (true)
+        {
+            const char *q = findJsonStringSpecial(p, end);
+            if (q == end)
+            {
+                token.append(p, end);
+                return end;
+            }
+            if (*q == '"')
+            {
+                token.append(p, q);
+                finishString();
+                return q + 1;
+            }
+            if (q + 1 == end) // '\' is the last byte of the chunk
+            {
+                token.append(p, end);
+                escapePending = true;
+                return end;
+            }
+            token.append(p, q + 2);
+            p = q + 2;
+        }
+    }
+
+    void finishString()
+    {
+        string val(token.size(), '\0');
+        val.resize(unescapeJsonString(token.data(), token.data() + token.size(), &val[0]) - val.data());
+        if (readingKey)
+        {
+            stack.back().key.swap(val);
+            state = State::COLON;
+            return;
+        }
+        Json str;
+        JsonFill::str(str).swap(val);
+        emit(std::move(str));
+    }
+
+    bool finishNumber()
+    {
+        Json num;
+        const char *end = parseJsonNumber(token.data(), token.data() + token.size(), num);
+        if (end != token.data() + token.size())
+            return fail("Invalid number.");
+        emit(std::move(num));
+        return true;
+    }
+
+    bool finishLiteral()
+    {
+        if (token == "null")
+            emit(Json());
+        else if (token == "true")
+            emit(Json(true));
+        else if (token == "false")
+            emit(Json(false));
+        else
+            return fail("Unexpected Constant.");
+        return true;
+    }
+
+    bool startValue(char ch)
+    {
+        token.clear();
+        if (ch == '"')
+        {
+            readingKey = false;
+            state = State::STRING;
+        }
+        else if (ch == '[')
+            open(Json::JsonType::JT_ARRAY);
+        else if (ch == '{')
+            open(Json::JsonType::JT_OBJECT);
+        else if (ch == '+' || ch == '-' || isJsonDigit(ch))
+        {
+            token += ch;
+            state = State::NUMBER;
+        }
+        else if (ch == 'n' || ch == 't' || ch == 'f')
+        {
+            token += ch;
+            state = State::LITERAL;
+        }
+        else
+            return fail("Undefined token '" + string(1, ch) + "'.");
+        return true;
+    }
+
+public:
+    // feed the next chunk of the document.
+    // returns false as soon as the input is known to be invalid
+    bool feed(const char *data, size_t size)
+    {
+        const char *p = data, *end = data + size;
+        while (p != end && state != State::ERROR)
+        {
+            // continue a token that may have started in an earlier chunk
+            if (state == State::STRING)
+            {
+                p = continueString(p, end);
+                continue;
+            }
+            if (state == State::NUMBER || state == State::LITERAL)
+            {
+                const char *q = p;
+                while (q != end && (state == State::NUMBER ? isNumberChar(*q) : isLiteralChar(*q)))
+                    q++;
+                token.append(p, q);
+                p = q;
+                if (p == end)
+                    break;
+                if (!(state == State::NUMBER ? finishNumber() : finishLiteral()))
+                    break;
+            }
+
+            p = skipJsonWhitespace(p, end);
+            if (p == end)
+                break;
+            char ch = *p++;
+            switch (state)
+            {
+            case State::VALUE:
+                startValue(ch);
+                break;
+            case State::ARRAY_VALUE:
+                if (ch == ']')
+                    close();
+                else
+                    startValue(ch);
+                break;
+            case State::OBJECT_KEY:
+                if (ch == '}')
+                    close();
+                else if (ch == '"')
+                {
+                    token.clear();
+                    readingKey = true;
+                    state = State::STRING;
+                }
+                else
+                    fail("Expected '\"'.");
+                break;
+            case State::COLON:
+                if (ch == ':')
+                    state = State::VALUE;
+                else
+                    fail("Expected ':'.");
+                break;
+            case State::AFTER_VALUE:
+            {
+                bool inArray = stack.back().value.isArray();
+                if (ch == ',')
+                    state = inArray ? State::ARRAY_VALUE : State::OBJECT_KEY;
+                else if (ch == (inArray ? ']' : '}'))
+                    close();
+                else
+                    fail(inArray ? "Expected ']'." : "Expected '}'.");
+                break;
+            }
+            default: // DONE
+                fail("Something went wrong!");
+                break;
+            }
+        }
+        return state != State::ERROR;
+    }
+
+    bool feed(string_view chunk) { return feed(chunk.data(), chunk.size()); }
+
+    // mark the end of the input, which completes a number or constant at the top level
+    bool finish()
+    {
+        if (state == State::NUMBER)
+            finishNumber();
+        else if (state == State::LITERAL)
+            finishLiteral();
+        if (state != State::DONE && state != State::ERROR)
+            fail("Unexpected end of input.");
+        return state == State::DONE;
+    }
+
+    // a complete document has been read
+    bool done() const { return state == State::DONE; }
+    bool isError() const { return state == State::ERROR; }
+
+    // hand over the parsed document, it is moved out of the parser
+    ParseResult result()
+    {
+        if (state == State::ERROR)
+            return ParseResult().setError(err);
+        if (state != State::DONE)
+            return ParseResult().setError("Unexpected end of input.");
+        return ParseResult().setJson(std::move(root));
+    }
+
+    // start over with a new document, keeping the allocated buffers
+    void reset()
+    {
+        state = State::VALUE;
+        stack.clear();
+        root = Json();
+        token.clear();
+        readingKey = false;
+        escapePending = false;
+        err.clear();
+    }
+};
+
+#endif // JSON_STREAM_H
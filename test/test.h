@@ -0,0 +1,30 @@
+/*
+    minimal checks shared by the test programs. every test is a standalone program run
+    from the repository root; a failed check is reported and makes it exit with 1.
+*/
+
+#ifndef JSON_TEST_H
+#define JSON_TEST_H
+
+#include "../src/json.h"
+
+static int testFailures = 0;
+
+#define CHECK(cond)                                                                  \
+    do                                                                               \
+    {                                                                                \
+        if (!(cond))                                                                 \
+        {                                                                            \
+            cout << __FILE__ << ":" << __LINE__ << ": check failed: " #cond << endl; \
+            testFailures++;                                                          \
+        }                                                                            \
+    } while (0)
+
+// exit code of a test program
+inline int testResult(const char *name)
+{
+    cout << name << (testFailures == 0 ? ": ok" : ": FAILED") << endl;
+    return testFailures == 0 ? 0 : 1;
+}
+
+#endif // JSON_TEST_H
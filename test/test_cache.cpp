@@ -0,0 +1,77 @@
+// JsonCache: hits for unchanged files, reloads when the size or modification time
+// changes, and least recently used trees evicted first
+
+#include "test.h"
+#include "../src/json_cache.h"
+
+static void writeFile(const string &filepath, const string &text)
+{
+    ofstream(filepath, ios::binary | ios::trunc) << text;
+}
+
+int main()
+{
+    string a = "build/test_cache_a.json", b = "build/test_cache_b.json", c = "build/test_cache_c.json",
+           d = "build/test_cache_d.json";
+    for (const string *filepath : {&a, &b, &c, &d})
+        writeFile(*filepath, "{\"name\":\"" + *filepath + "\",\"n\":[1,2,3]}");
+
+    JsonCache cache;
+    shared_ptr<const Json> first = cache.read(a);
+    CHECK(first && (*first)["name"].getString() == a);
+    CHECK(cache.read(a) == first);
+    JsonCache::Stats stats = cache.getStats();
+    CHECK(stats.hits == 1 && stats.misses == 1 && stats.entries == 1);
+
+    // the same size but a later modification time
+    writeFile(a, "{\"name\":\"build/test_cache_A.json\",\"n\":[1,2,3]}");
+    filesystem::last_write_time(a, filesystem::last_write_time(a) + chrono::seconds(5));
+    shared_ptr<const Json> second = cache.read(a);
+    CHECK(second && second != first && (*second)["name"].getString() == "build/test_cache_A.json");
+    // a tree handed out before stays as it was
+    CHECK((*first)["name"].getString() == a);
+
+    // another size, even with the modification time set back
+    auto mtime = filesystem::last_write_time(a);
+    writeFile(a, "{\"name\":\"changed\"}");
+    filesystem::last_write_time(a, mtime);
+    shared_ptr<const Json> third = cache.read(a);
+    CHECK(third && third != second && (*third)["name"].getString() == "changed");
+
+    // broken and missing files are reported and not cached
+    string err;
+    writeFile(d, "{\"broken\":");
+    CHECK(cache.read(d, &err) == nullptr && !err.empty());
+    CHECK(cache.read("build/test_cache_missing.json", &err) == nullptr && err.find("not found") != string::npos);
+    writeFile(d, "{\"name\":\"build/test_cache_d.json\",\"n\":[1,2,3]}");
+
+    // room for three trees of this size: reading a fourth drops the least recently used
+    writeFile(a, "{\"name\":\"build/test_cache_a.json\",\"n\":[1,2,3]}");
+    cache.clear();
+    cache.read(a);
+    size_t treeBytes = cache.getStats().bytes;
+    cache.setMaxBytes(3 * treeBytes + treeBytes / 2);
+    cache.read(b);
+    cache.read(c);
+    cache.read(a); // b is now the least recently used
+    stats = cache.getStats();
+    cache.read(d);
+    CHECK(cache.getStats().evictions == stats.evictions + 1 && cache.getStats().entries == 3);
+    stats = cache.getStats();
+    cache.read(a);
+    cache.read(c);
+    cache.read(d);
+    CHECK(cache.getStats().hits == stats.hits + 3);
+    cache.read(b);
+    CHECK(cache.getStats().misses == stats.misses + 1);
+
+    // a tree larger than the cap is handed out but not kept
+    cache.setMaxBytes(treeBytes / 2);
+    CHECK(cache.getStats().entries == 0);
+    CHECK(cache.read(a) && cache.getStats().entries == 0);
+
+    CHECK(cache.erase(a) == false);
+    for (const string *filepath : {&a, &b, &c, &d})
+        remove(filepath->c_str());
+    return testResult("test_cache");
+}
@@ -0,0 +1,73 @@
+// cbor round trips of the test files and of every JsonType
+
+#include "test.h"
+#include "../src/json_cbor.h"
+
+static string hexBytes(const string &hex)
+{
+    string res;
+    for (size_t i = 0; i + 1 < hex.size(); i += 2)
+        res.push_back(char(stoi(hex.substr(i, 2), nullptr, 16)));
+    return res;
+}
+
+static bool roundTrips(const Json &json)
+{
+    ParseResult res = parseCbor(dumpCbor(json));
+    return !res.isError() && res.getJson().dump() == json.dump();
+}
+
+int main()
+{
+    for (const char *filepath : {"test/test1.json", "test/test2.json"})
+    {
+        ParseResult json = readJson(filepath);
+        CHECK(!json.isError());
+        CHECK(roundTrips(json.getJson()));
+
+        // streamed through an ostream, the bytes are the same
+        ostringstream out;
+        CborWriter(out).write(json.getJson());
+        CHECK(out.str() == dumpCbor(json.getJson()));
+    }
+
+    // every JsonType, integers come back in the smallest type that fits them
+    Json all = JsonArray(nullptr, true, false, 0, -1, INT32_MIN, INT32_MAX, int64_t(1) << 40, INT64_MIN,
+                         UINT64_MAX, 0.5, 0.1, -1.2e44, "", "short", string(300, 'x'), JsonArray(),
+                         JsonObject(), JsonObject(JsonPair{"a", JsonArray(1, "b")}));
+    CHECK(roundTrips(all));
+    Json back = parseCbor(dumpCbor(all)).takeJson();
+    CHECK(back[7].isInt64() && back[8].isInt64() && back[9].isUInt64());
+    CHECK(parseCbor(dumpCbor(Json(int64_t(5)))).getJson().isInt());
+
+    // doubles that are exact as floats take 4 bytes
+    CHECK(dumpCbor(Json(0.5)).size() == 5);
+    CHECK(dumpCbor(Json(0.1)).size() == 9);
+    // and doubles beyond the float range 8
+    CHECK(dumpCbor(Json(1e300)).size() == 9 && dumpCbor(Json(-1e300)).size() == 9);
+    CHECK(parseCbor(dumpCbor(Json(1e300))).getJson().getDouble() == 1e300);
+    CHECK(dumpCbor(Json(double(FLT_MAX))).size() == 5);
+
+    // a streamed document with and without lengths
+    string bin;
+    {
+        CborWriter w(bin);
+        w.beginObject(2).writeKey("id").writeInt(7).writeKey("tags").beginArray();
+        w.writeString("x").writeString("y").end();
+    }
+    CHECK(parseCbor(bin).getJson().dump(0, "") == "{\"id\":7,\"tags\":[\"x\",\"y\"]}");
+
+    // examples of RFC 8949 appendix A
+    CHECK(parseCbor(hexBytes("f93c00")).getJson().getDouble() == 1.0);
+    CHECK(parseCbor(hexBytes("3bffffffffffffffff")).getJson().getDouble() == -18446744073709551616.0);
+    CHECK(parseCbor(hexBytes("7f657374726561646d696e67ff")).getJson().getString() == "streaming");
+    CHECK(parseCbor(hexBytes("bf61610161629f0203ffff")).getJson().dump(0, "") == "{\"a\":1,\"b\":[2,3]}");
+    CHECK(parseCbor(hexBytes("c074323031332d30332d32315432303a30343a30305a")).getJson().getString() == "2013-03-21T20:04:00Z");
+
+    // malformed input
+    for (const char *hex : {"", "ff", "1c", "8301", "a10102", "9bffffffffffffffff", "0000"})
+        CHECK(parseCbor(hexBytes(hex)).isError());
+    CHECK(parseCbor(string(100000, '\x81')).isError());
+
+    return testResult("test_cbor");
+}
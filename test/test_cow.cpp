@@ -0,0 +1,125 @@
+// value semantics of copies with JSON_COPY_ON_WRITE
+
+#define JSON_COPY_ON_WRITE
+#include "test.h"
+#include "../src/json_cbor.h"
+#include "../src/json_document.h"
+#include "../src/json_flat.h"
+#include "../src/json_lazy.h"
+#include "../src/json_parallel.h"
+#include "../src/json_stream.h"
+
+// the strings, arrays and objects of a and b that are not the same payload
+static size_t unshared(const Json &a, const Json &b)
+{
+    if (a.isString())
+        return &a.getString() != &b.getString();
+    if (a.isArray())
+    {
+        size_t n = &a.getArray() != &b.getArray();
+        for (size_t i = 0; i < a.size(); i++)
+            n += unshared(a[i], b[i]);
+        return n;
+    }
+    if (a.isObject())
+    {
+        size_t n = &a.getObject() != &b.getObject();
+        for (const auto &member : a.getObject())
+            n += unshared(member.second, b[member.first]);
+        return n;
+    }
+    return 0;
+}
+
+// a tree made by one of the parsers is shared by a copy of it
+static void checkShared(const char *name, const Json &json)
+{
+    const Json copy = json;
+    size_t n = unshared(json, copy);
+    if (n != 0)
+        cout << name << ": " << n << " payloads copied" << endl;
+    CHECK(!json.isNull() && n == 0);
+    CHECK(copy.dump() == json.dump());
+}
+
+int main()
+{
+    // a member reference taken before a copy must not write into the copy
+    {
+        Json j = JsonObject(JsonPair{"a", 1});
+        Json &c = j["a"];
+        Json copy = j;
+        c = 5;
+        CHECK(copy["a"].getInt() == 1);
+        CHECK(j["a"].getInt() == 5);
+    }
+
+    // nor may a container reference
+    {
+        Json j = JsonObject(JsonPair{"arr", JsonArray(1, 2, 3)});
+        vector<Json> &v = j["arr"].getArray();
+        Json copy = j;
+        v.push_back(4);
+        CHECK(copy["arr"].size() == 3);
+        CHECK(j["arr"].size() == 4);
+    }
+
+    // or a string reference, also through copy assignment
+    {
+        Json j = JsonArray("abc");
+        string &s = j[0].getString();
+        Json copy;
+        copy = j;
+        s += "def";
+        CHECK(copy[0].getString() == "abc");
+        CHECK(j[0].getString() == "abcdef");
+    }
+
+    // modifying either side after a copy leaves the other alone
+    {
+        Json j = JsonObject(JsonPair{"a", JsonArray(1, 2)});
+        Json copy = j;
+        j["a"].push_back(3);
+        copy["b"] = true;
+        CHECK(j["a"].size() == 3 && !j.contains("b"));
+        CHECK(copy["a"].size() == 2 && copy.contains("b"));
+    }
+
+    // parsed trees are shared by copies until one of them is modified
+    {
+        ParseResult res = readJson("test/test2.json");
+        CHECK(!res.isError());
+        const Json &j = res.getJson();
+        const Json copy = j;
+        CHECK(&copy.getObject() == &j.getObject());
+        CHECK(&copy["web-app"]["servlet"].getArray() == &j["web-app"]["servlet"].getArray());
+        CHECK(copy.dump() == j.dump());
+    }
+
+    // so are the trees of every other parser and converter
+    {
+        JsonFileBuffer file("test/test2.json");
+        string_view text = file.view();
+        checkShared("parseJson", parseJson(text).getJson());
+        checkShared("parseJsonIndexed", parseJsonIndexed(text).getJson());
+        checkShared("parseJsonParallel", parseJsonParallel(string("[") + string(text) + "," + string(text) + "]", 2).getJson());
+        JsonPushParser push;
+        push.feed(text);
+        push.finish();
+        checkShared("JsonPushParser", push.result().getJson());
+        Json json = parseJson(text).takeJson();
+        checkShared("parseCbor", parseCbor(dumpCbor(json)).getJson());
+        LazyJsonDocument lazy;
+        lazy.parse(text);
+        checkShared("LazyJson", lazy.root().toJson());
+        JsonDocument doc;
+        doc.parse(text);
+        checkShared("JsonElement", doc.root().toJson());
+        JsonFlatFile flat;
+        string bytes = dumpJsonFlat(json);
+        flat.parse(bytes);
+        checkShared("JsonFlatElement", flat.root().toJson());
+    }
+
+    return testResult("test_cow");
+}
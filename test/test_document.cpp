@@ -0,0 +1,38 @@
+// JsonDocument gives the same trees as parseJson
+
+#include "test.h"
+#include "../src/json_document.h"
+
+static void checkSame(const string &text)
+{
+    JsonDocument doc;
+    CHECK(parseJson(text, doc));
+    Json expected = parseJson(text).takeJson();
+    CHECK(doc.root().toJson().dump() == expected.dump());
+    if (expected.isObject())
+    {
+        CHECK(doc.root().size() == expected.size());
+        for (const auto &member : expected.getObject())
+            CHECK(doc[member.first].toJson().dump() == member.second.dump());
+    }
+}
+
+int main()
+{
+    JsonFileBuffer file("test/test2.json");
+    CHECK(file.isOpen());
+    checkSame(string(file.view()));
+
+    // a repeated key takes the last value, in small objects and in large ones
+    checkSame("{\"a\":1,\"a\":2}");
+    checkSame("{\"a\":1,\"b\":[1],\"a\":{\"x\":3},\"c\":4,\"b\":5}");
+    checkSame("{\"k0\":0,\"k1\":1,\"k2\":2,\"k3\":3,\"k4\":4,\"k5\":5,\"k6\":6,\"k7\":7,\"k8\":8,"
+              "\"k2\":22,\"a long key that is not inline\":1,\"a long key that is not inline\":2,\"k0\":100}");
+
+    // errors are those of parseJson
+    JsonDocument doc;
+    CHECK(!parseJson("{\"a\":1,", doc) && doc.getError() == parseJson("{\"a\":1,").getError());
+    CHECK(readJson("test/test2.json", doc) && doc.root().isObject());
+
+    return testResult("test_document");
+}
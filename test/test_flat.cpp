@@ -0,0 +1,77 @@
+// flat files: round trips against parseJson, and damaged files rejected or throwing
+
+#include "test.h"
+#include "../src/json_flat.h"
+
+static bool throws(const JsonFlatElement &e)
+{
+    try
+    {
+        e.toJson();
+    }
+    catch (const char *)
+    {
+        return true;
+    }
+    return false;
+}
+
+int main()
+{
+    for (const char *filepath : {"test/test1.json", "test/test2.json"})
+    {
+        Json json = readJson(filepath).takeJson();
+        string flatpath = "build/test_flat.jsonf";
+        CHECK(writeJsonFlat(json, flatpath));
+        JsonFlatFile file;
+        CHECK(file.read(flatpath));
+        CHECK(file.root().toJson().dump() == json.dump());
+        file.close();
+        remove(flatpath.c_str());
+    }
+
+    // every JsonType, short and long strings and keys, found by key and in key order
+    Json all = JsonObject(JsonPair{"null", nullptr}, JsonPair{"bools", JsonArray(true, false)},
+                          JsonPair{"ints", JsonArray(0, -1, INT32_MAX, int64_t(1) << 40, UINT64_MAX)},
+                          JsonPair{"doubles", JsonArray(0.5, -1.25e300)},
+                          JsonPair{"a key longer than fourteen bytes", string(100, 's')}, JsonPair{"short", "abc"},
+                          JsonPair{"empty", JsonArray(JsonArray(), JsonObject(), "")});
+    string bytes = dumpJsonFlat(all);
+    JsonFlatFile file;
+    CHECK(file.parse(bytes));
+    CHECK(file.root().toJson().dump() == all.dump());
+    CHECK(file["ints"][3].getInt64() == int64_t(1) << 40 && file["ints"][4].getUInt64() == UINT64_MAX);
+    CHECK(file["a key longer than fourteen bytes"].getString() == string(100, 's'));
+    CHECK(file["short"].getString() == "abc" && file.root().contains("null") && !file.root().contains("nope"));
+    for (size_t i = 0; i + 1 < file.root().size(); i++)
+        CHECK(file.root().keyAt(i) < file.root().keyAt(i + 1));
+
+    // a file cut short is rejected when it is opened, at any length
+    for (size_t n : {size_t(0), size_t(4), sizeof(JsonFlatHeader) - 1, sizeof(JsonFlatHeader), bytes.size() / 2,
+                     bytes.size() - 1})
+    {
+        string cut = bytes.substr(0, n);
+        CHECK(!file.parse(cut) && file.isError() && !file.isOpen());
+    }
+    string longer = bytes + string(8, '\0');
+    CHECK(!file.parse(longer));
+
+    // so are other files and other versions
+    string text = "{\"not\":\"a flat file, but long enough to hold a header\"}";
+    CHECK(!file.parse(text) && file.getError() == "Not a flat json file.");
+    string future = bytes;
+    future[4]++;
+    CHECK(!file.parse(future) && file.getError().find("version") != string::npos);
+    CHECK(!file.read("build/missing.jsonf"));
+
+    // an offset pointing outside the file throws instead of being followed
+    string damaged = bytes;
+    JsonFlatHeader header;
+    memcpy(&header, damaged.data(), sizeof(header));
+    header.root.offset = damaged.size() + 64;
+    memcpy(&damaged[0], &header, sizeof(header));
+    CHECK(file.parse(damaged));
+    CHECK(throws(file.root()));
+
+    return testResult("test_flat");
+}
@@ -0,0 +1,38 @@
+// parseJsonIndexed against parseJson: the same tree or the same error for every input
+
+#include "test.h"
+#include "../src/json_index.h"
+
+static void checkSame(string_view s)
+{
+    ParseResult expected = parseJson(s);
+    ParseResult res = parseJsonIndexed(s);
+    bool same = res.isError() == expected.isError() &&
+                (res.isError() ? res.getError() == expected.getError() : res.getJson().dump() == expected.getJson().dump());
+    if (!same)
+        cout << "'" << s << "': " << (res.isError() ? res.getError() : res.getJson().dump(0, "")) << " instead of "
+             << (expected.isError() ? expected.getError() : expected.getJson().dump(0, "")) << endl;
+    CHECK(same);
+}
+
+int main()
+{
+    for (const char *filepath : {"test/test1.json", "test/test2.json"})
+    {
+        JsonFileBuffer file(filepath);
+        CHECK(file.isOpen());
+        checkSame(file.view());
+        // and every prefix of it, which are all broken in some way
+        for (size_t k = 0; k < file.size(); k += 7)
+            checkSame(file.view().substr(0, k));
+    }
+
+    for (string s : {"{\"a\":1,}x", "[1,2", "{\"a\" 1}", "[tru]", "\"abc", "[1] 2", "-", "", "  ", "[", "]", "{", "}",
+                     "[1,]", "[,1]", "{\"a\":}", "{\"a\"}", "{1:2}", "{\"a\":1 \"b\":2}", "[1 2]", "[\"a\" \"b\"]",
+                     "nul", "nulls", "truex", "[true false]", "01", "1.", ".5", "1e", "--1", "+1", "1 2", "\"a\\\"",
+                     "[\"unterminated]", "{\"a\":[1,{\"b\":2]}}", "[[[]]", "[]]", "{\"a\":1}}", "x", "[x]",
+                     "{\"a\":1,\"a\":2}", "\"\\u00e9\\n\"", "[1e400]", "[-0]", "[18446744073709551616]"})
+        checkSame(s);
+
+    return testResult("test_index");
+}
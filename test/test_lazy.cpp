@@ -0,0 +1,104 @@
+// LazyJsonDocument read value by value against the tree of parseJson
+
+#include "test.h"
+#include "../src/json_lazy.h"
+
+// every value below lazy, reached through its accessors, against the same value of json
+static void checkSame(LazyJson lazy, const Json &json)
+{
+    CHECK(lazy.getType() == json.getType());
+    switch (json.getType())
+    {
+    case Json::JsonType::JT_BOOL:
+        CHECK(lazy.getBool() == json.getBool());
+        break;
+    case Json::JsonType::JT_INT:
+        CHECK(lazy.getInt() == json.getInt());
+        break;
+    case Json::JsonType::JT_INT64:
+        CHECK(lazy.getInt64() == json.getInt64());
+        break;
+    case Json::JsonType::JT_UINT64:
+        CHECK(lazy.getUInt64() == json.getUInt64());
+        break;
+    case Json::JsonType::JT_DOUBLE:
+        CHECK(lazy.getDouble() == json.getDouble());
+        break;
+    case Json::JsonType::JT_STRING:
+        CHECK(lazy.getString() == json.getString());
+        break;
+    case Json::JsonType::JT_ARRAY:
+        CHECK(lazy.size() == json.size());
+        for (size_t i = 0; i < json.size(); i++)
+            checkSame(lazy[i], json[i]);
+        break;
+    case Json::JsonType::JT_OBJECT:
+        CHECK(lazy.size() == json.size());
+        for (const auto &member : json.getObject())
+        {
+            CHECK(lazy.contains(member.first));
+            checkSame(lazy[member.first], member.second);
+        }
+        break;
+    default:
+        CHECK(lazy.isNull());
+    }
+    CHECK(lazy.toJson().dump() == json.dump());
+}
+
+static void checkText(string_view text)
+{
+    LazyJsonDocument doc;
+    CHECK(doc.parse(text));
+    checkSame(doc.root(), parseJson(text).getJson());
+}
+
+int main()
+{
+    for (const char *filepath : {"test/test1.json", "test/test2.json"})
+    {
+        LazyJsonDocument doc;
+        CHECK(doc.read(filepath));
+        checkSame(doc.root(), readJson(filepath).getJson());
+    }
+
+    // escapes, repeated keys, empty containers and every kind of number
+    checkText("{\"a\\\"b\":\"x\\ny\",\"k\":1,\"k\":[2,{}],\"e\":[],\"u\":\"\\u00e9\"}");
+    checkText("[0,-1,2147483648,-9223372036854775808,18446744073709551615,1.5e3,true,false,null]");
+    checkText("  \"just a string\"  ");
+    checkText("42");
+
+    // accessors on the wrong type throw as Json does
+    LazyJsonDocument doc;
+    CHECK(doc.parse("{\"a\":[1,2]}"));
+    bool threw = false;
+    try
+    {
+        doc["b"];
+    }
+    catch (const char *)
+    {
+        threw = true;
+    }
+    CHECK(threw);
+    threw = false;
+    try
+    {
+        doc["a"][2];
+    }
+    catch (const char *)
+    {
+        threw = true;
+    }
+    CHECK(threw);
+    CHECK(!doc["a"].isObject() && !doc.root().contains("b"));
+
+    // broken nesting and strings are found when the document is indexed
+    for (string bad : {"[1,2", "{\"a\":[1}", "[1]]", "\"abc", "[\"abc]", "", "[1] 2"})
+    {
+        CHECK(!doc.parse(bad));
+        CHECK(doc.isError());
+    }
+
+    return testResult("test_lazy");
+}
@@ -0,0 +1,48 @@
+// JsonLinesReader gives every record with its line number, on one thread and on several
+
+#include <sstream>
+#include "test.h"
+#include "../src/json_ndjson.h"
+
+// line number and dump of every record read from text
+static vector<pair<size_t, string>> readAll(const string &text, size_t threads, size_t blockSize, size_t stopAfter = SIZE_MAX)
+{
+    vector<pair<size_t, string>> res;
+    JsonLinesReader reader([&](size_t line, ParseResult &rec) {
+        res.emplace_back(line, rec.isError() ? "error" : rec.getJson().dump());
+        return res.size() < stopAfter;
+    }, threads, true, blockSize);
+    istringstream in(text);
+    CHECK(reader.read(in));
+    CHECK(reader.recordCount() == res.size());
+    return res;
+}
+
+int main()
+{
+    string text;
+    vector<pair<size_t, string>> expected;
+    for (int i = 0; i < 500; i++)
+    {
+        if (i % 7 == 3)
+            text += "   \n"; // blank lines are no records
+        // one line far longer than the blocks it is read in
+        string rec = "{\"i\":" + to_string(i) + ",\"s\":\"" + string(i == 250 ? 100000 : i % 13, 'x') + "\"}";
+        if (i % 50 == 10)
+            rec = "{\"broken\":"; // reported as an error, reading goes on
+        text += rec + "\n";
+        expected.emplace_back(count(text.begin(), text.end(), '\n'), rec[2] == 'b' ? "error" : parseJson(rec).getJson().dump());
+    }
+    text += "[1,2]"; // no newline at the end
+    expected.emplace_back(count(text.begin(), text.end(), '\n') + 1, parseJson("[1,2]").getJson().dump());
+
+    for (size_t threads : {1, 4})
+        for (size_t blockSize : {1, 100, 1 << 16})
+        {
+            CHECK(readAll(text, threads, blockSize) == expected);
+            auto first = readAll(text, threads, blockSize, 10);
+            CHECK(first.size() == 10 && equal(first.begin(), first.end(), expected.begin()));
+        }
+
+    return testResult("test_ndjson");
+}
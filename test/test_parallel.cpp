@@ -0,0 +1,51 @@
+// JsonParallelParser against parseJson, on arrays of records, numbers and strings
+
+#include "test.h"
+#include "../src/json_parallel.h"
+
+// parse s on threads threads, the result has to match parseJson(s)
+static size_t checkSame(string_view s, size_t threads)
+{
+    JsonParallelParser parser(threads, 0);
+    ParseResult res = parser.parse(s);
+    ParseResult expected = parseJson(s);
+    CHECK(res.isError() == expected.isError());
+    if (res.isError())
+        CHECK(res.getError() == expected.getError());
+    else
+        CHECK(res.getJson().dump() == expected.getJson().dump());
+    return parser.keptChunks();
+}
+
+int main()
+{
+    string records = "[", numbers = "[", strings = "[", tricky = "[";
+    for (int i = 0; i < 2000; i++)
+    {
+        string sep = i ? ", " : "";
+        records += sep + "{\"id\":" + to_string(i) + ",\"tags\":[\"a\",\"b\"],\"n\":{\"x\":[1,2]}}";
+        numbers += sep + to_string(i * 0.5 - 300);
+        strings += sep + "\"s " + to_string(i) + "\"";
+        // commas and brackets inside strings and nested arrays lead to wrong guesses
+        tricky += sep + "[\"},{\", \"a, true\", [" + to_string(-i) + ", " + to_string(i) + "]]";
+    }
+    for (string *s : {&records, &numbers, &strings, &tricky})
+        *s += "]";
+
+    for (size_t threads : {2, 3, 4, 8})
+    {
+        // every kind of array is split, not only arrays of records
+        CHECK(checkSame(records, threads) == threads);
+        CHECK(checkSame(numbers, threads) == threads);
+        CHECK(checkSame(strings, threads) == threads);
+        checkSame(tricky, threads);
+    }
+
+    // wrong guesses and broken input end like parseJson
+    for (string s : {"[1,2,3", "[1,2,,3]", "[{\"a\":1},{\"a\":2}] x", "[\"a,b\",\"c\"]", "{\"a\":[1,2]}", "[]", "[1,]"})
+        for (size_t threads : {2, 4})
+            checkSame(s, threads);
+    CHECK(checkSame("{\"a\":[1,2]}", 4) == 0);
+
+    return testResult("test_parallel");
+}
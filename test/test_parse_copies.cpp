@@ -0,0 +1,73 @@
+// the parse path allocates every string, array and object exactly once and never copies one
+
+#define JSON_COUNT_ALLOCATIONS
+#include "test.h"
+
+// strings, arrays and objects in a tree, the values that own an allocation
+static size_t countPayloads(const Json &json)
+{
+    size_t n = 0;
+    if (json.isString())
+        n = 1;
+    else if (json.isArray())
+    {
+        n = 1;
+        for (const auto &elem : json.getArray())
+            n += countPayloads(elem);
+    }
+    else if (json.isObject())
+    {
+        n = 1;
+        for (const auto &member : json.getObject())
+            n += countPayloads(member.second);
+    }
+    return n;
+}
+
+// run parse and check the allocations it made against the tree it returned
+template <class Parse>
+static void checkParse(const char *name, Parse parse)
+{
+    size_t allocations = jsonPayloadAllocations, copies = jsonPayloadCopies;
+    Json json = parse();
+    allocations = jsonPayloadAllocations - allocations;
+    copies = jsonPayloadCopies - copies;
+    size_t payloads = countPayloads(json);
+    if (allocations != payloads || copies != 0)
+        cout << name << ": " << allocations << " allocations, " << copies << " copies for "
+             << payloads << " values" << endl;
+    CHECK(payloads > 0);
+    CHECK(allocations == payloads);
+    CHECK(copies == 0);
+}
+
+int main()
+{
+    JsonFileBuffer file("test/test2.json");
+    CHECK(file.isOpen());
+    string_view text = file.view();
+
+    checkParse("parseJson", [&] { return parseJson(text).takeJson(); });
+    checkParse("readJson", [] { return readJson("test/test2.json").getJson(); });
+    checkParse("JsonParser", [&] {
+        static JsonParser parser;
+        return std::move(parser.parse(text)).getJson();
+    });
+    checkParse("ParseResult move", [&] {
+        ParseResult res = parseJson(text);
+        ParseResult moved = std::move(res);
+        return moved.takeJson();
+    });
+
+    // the counter does see copies, which only share the tree with JSON_COPY_ON_WRITE
+    Json json = parseJson(text).takeJson();
+    size_t copies = jsonPayloadCopies;
+    Json copy = json;
+#ifdef JSON_COPY_ON_WRITE
+    CHECK(jsonPayloadCopies - copies == 0);
+#else
+    CHECK(jsonPayloadCopies - copies == countPayloads(json));
+#endif
+
+    return testResult("test_parse_copies");
+}
@@ -0,0 +1,57 @@
+// JsonProjection keeps the selected values and checks the skipped ones
+
+#include "test.h"
+#include "../src/json_query.h"
+
+static string project(const vector<string> &paths, const string &text)
+{
+    JsonProjection projection(paths);
+    ParseResult res = projection.parse(text);
+    return res.isError() ? "error: " + res.getError() : res.getJson().dump();
+}
+
+// text as the projection dumps it
+static string dumped(const string &text)
+{
+    return parseJson(text).getJson().dump();
+}
+
+static bool fails(const vector<string> &paths, const string &text)
+{
+    return project(paths, text).compare(0, 6, "error:") == 0;
+}
+
+int main()
+{
+    // the whole document is the same as parseJson
+    JsonFileBuffer file("test/test2.json");
+    CHECK(file.isOpen());
+    string text(file.view());
+    CHECK(project({""}, text) == parseJson(text).getJson().dump());
+
+    CHECK(project({"/a"}, "{\"a\":1,\"b\":{\"c\":[1,2,\"]}\"]}}") == dumped("{\"a\":1}"));
+    CHECK(project({"/x/*/id"}, "{\"x\":[{\"id\":1,\"n\":[{}]},{\"id\":2}]}") ==
+          dumped("{\"x\":[{\"id\":1},{\"id\":2}]}"));
+
+    // brackets of the wrong kind
+    CHECK(fails({"/a"}, "{\"a\":1,\"b\":[1,{]]}"));
+    CHECK(fails({"/a"}, "{\"a\":1,\"b\":[}"));
+    CHECK(fails({"/a"}, "{\"a\":1,\"b\":{\"c\":[1,2}}"));
+    CHECK(fails({"/a"}, "[}"));
+    CHECK(project({"/a"}, "{\"a\":1,\"b\":[[{\"c\":2}]]") == "error: Expected '}'.");
+    CHECK(project({"/a"}, "{\"a\":1,\"b\":[[{\"c\":2") == "error: Expected '}'.");
+    CHECK(project({"/a"}, "{\"a\":1,\"b\":[[{\"c\":2}") == "error: Expected ']'.");
+
+    // skipped scalars
+    CHECK(fails({"/a"}, "{\"a\":1,\"b\":garbage}"));
+    CHECK(fails({"/a"}, "{\"a\":1,\"b\":nul}"));
+    CHECK(fails({"/a"}, "{\"a\":1,\"b\":-}"));
+    CHECK(fails({"/a"}, "{\"a\":1,\"b\":\"open}"));
+    CHECK(project({"/a"}, "{\"a\":1,\"b\":true,\"c\":-1.5e3,\"d\":null}") == dumped("{\"a\":1}"));
+
+    // nesting deeper than the bracket stack
+    CHECK(fails({"/a"}, "{\"a\":1,\"b\":" + string(5000, '[') + string(5000, ']') + "}"));
+    CHECK(project({"/a"}, "{\"a\":1,\"b\":" + string(4000, '[') + string(4000, ']') + "}") == dumped("{\"a\":1}"));
+
+    return testResult("test_projection");
+}
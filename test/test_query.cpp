@@ -0,0 +1,103 @@
+// JsonPointer on the examples of RFC 6901, and JsonPath selectors and filters
+
+#include "test.h"
+#include "../src/json_query.h"
+
+static bool throws(string_view text, bool pointer)
+{
+    try
+    {
+        if (pointer)
+            JsonPointer p(text);
+        else
+            JsonPath p(text);
+    }
+    catch (const char *)
+    {
+        return true;
+    }
+    return false;
+}
+
+// the dumps of the values path selects, one after another
+static string selected(const Json &root, const char *path)
+{
+    string res;
+    for (const Json *json : JsonPath(path).select(root))
+        res += (res.empty() ? "" : " ") + json->dump(0, "");
+    return res;
+}
+
+int main()
+{
+    // RFC 6901 section 5
+    Json doc = parseJson(R"({"foo": ["bar", "baz"], "": 0, "a/b": 1, "c%d": 2, "e^f": 3, "g|h": 4,
+                             "i\\j": 5, "k\"l": 6, " ": 7, "m~n": 8, "~1": 9})").takeJson();
+    CHECK(JsonPointer("").find(doc) == &doc);
+    CHECK(JsonPointer("/foo").at(doc).dump(0, "") == "[\"bar\",\"baz\"]");
+    CHECK(JsonPointer("/foo/0").at(doc).getString() == "bar");
+    const pair<const char *, int> members[] = {{"/", 0}, {"/a~1b", 1}, {"/c%d", 2}, {"/e^f", 3}, {"/g|h", 4},
+                                               {"/i\\j", 5}, {"/k\"l", 6}, {"/ ", 7}, {"/m~0n", 8}};
+    for (const auto &member : members)
+        CHECK(JsonPointer(member.first).at(doc).getInt() == member.second);
+    // ~01 is "~1", not "/": ~0 is unescaped after ~1
+    CHECK(JsonPointer("/~01").at(doc).getInt() == 9);
+    CHECK(JsonPointer("/a~1b").size() == 1);
+
+    // missing values, "-", leading zeros and indices into objects find nothing
+    for (const char *missing : {"/foo/2", "/foo/-", "/foo/01", "/foo/bar", "/nope", "/a/b", "/foo/0/x"})
+        CHECK(JsonPointer(missing).find(doc) == nullptr);
+    for (const char *bad : {"foo", "/~", "/~2", "/a~"})
+        CHECK(throws(bad, true));
+
+    // a mutable pointer writes into the tree
+    *JsonPointer("/foo/1").find(doc) = "qux";
+    CHECK(doc["foo"][1].getString() == "qux");
+
+    Json store = parseJson(R"({"store": {
+        "book": [
+            {"category": "reference", "author": "Rees", "title": "Sayings", "price": 8.95},
+            {"category": "fiction", "author": "Waugh", "title": "Sword", "price": 12.99},
+            {"category": "fiction", "author": "Melville", "title": "Moby Dick", "isbn": "0-553", "price": 8.99},
+            {"category": "fiction", "author": "Tolkien", "title": "The Lord", "isbn": "0-395", "price": 22.99}
+        ],
+        "bicycle": {"color": "red", "price": 19.95, "new": true}}})").takeJson();
+
+    CHECK(selected(store, "$.store.book[0].author") == "\"Rees\"");
+    CHECK(selected(store, "$['store']['book'][-1].author") == "\"Tolkien\"");
+    CHECK(selected(store, "$.store.book[*].author") == "\"Rees\" \"Waugh\" \"Melville\" \"Tolkien\"");
+    CHECK(selected(store, "$..author") == "\"Rees\" \"Waugh\" \"Melville\" \"Tolkien\"");
+    CHECK(selected(store, "$.store.*").size() > 0 && JsonPath("$.store.*").count(store) == 2);
+    CHECK(JsonPath("$..price").count(store) == 5);
+    CHECK(selected(store, "$..book[2].title") == "\"Moby Dick\"");
+    CHECK(selected(store, "$.store.book[9]") == "" && JsonPath("$.nope").first(store) == nullptr);
+
+    // filters: existence and every comparison, against numbers, strings and bools
+    CHECK(selected(store, "$..book[?(@.isbn)].title") == "\"Moby Dick\" \"The Lord\"");
+    CHECK(selected(store, "$..book[?(@.price < 10)].title") == "\"Sayings\" \"Moby Dick\"");
+    CHECK(selected(store, "$..book[?(@.price <= 8.99)].title") == "\"Sayings\" \"Moby Dick\"");
+    CHECK(selected(store, "$..book[?(@.price > 20)].title") == "\"The Lord\"");
+    CHECK(selected(store, "$..book[?(@.price >= 22.99)].title") == "\"The Lord\"");
+    CHECK(selected(store, "$..book[?(@.author == 'Waugh')].price") == "12.99");
+    CHECK(JsonPath("$..book[?(@.category != \"fiction\")]").count(store) == 1);
+    CHECK(JsonPath("$.store[?(@.new == true)].color").count(store) == 1);
+    // values of different types are never equal
+    CHECK(JsonPath("$..book[?(@.price == '8.95')]").count(store) == 0);
+    CHECK(JsonPath("$..book[?(@.price != '8.95')]").count(store) == 4);
+    CHECK(JsonPath("$..book[?(@.isbn == null)]").count(store) == 0);
+
+    // first() stops at the first match in document order
+    CHECK(JsonPath("$..book[?(@.price > 10)].title").first(store)->getString() == "Sword");
+
+    // the query in the header comment on test2.json
+    ParseResult res = readJson("test/test2.json");
+    CHECK(!res.isError());
+    JsonPath templates("$['web-app'].servlet[?(@.init-param.useJSP == false)]..templatePath");
+    CHECK(templates.count(res.getJson()) == 1);
+    CHECK(templates.first(res.getJson())->getString() == "templates");
+
+    for (const char *bad : {"", "store", "$.", "$[", "$['a'", "$[?(@.a ==)]", "$.a[?(x)]", "$[1x]", "$.a.."})
+        CHECK(throws(bad, false));
+
+    return testResult("test_query");
+}
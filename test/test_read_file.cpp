@@ -0,0 +1,54 @@
+// readJson on regular files, empty files and pipes, against parsing the same text
+
+#include <thread>
+#include <sys/stat.h>
+#include "test.h"
+
+static string slurp(const char *filepath)
+{
+    ifstream fin(filepath, ios::binary);
+    ostringstream out;
+    out << fin.rdbuf();
+    return out.str();
+}
+
+int main()
+{
+    for (const char *filepath : {"test/test1.json", "test/test2.json"})
+    {
+        string text = slurp(filepath);
+        JsonFileBuffer file(filepath);
+        CHECK(file.isOpen() && file.view() == text);
+        ParseResult res = readJson(filepath);
+        CHECK(!res.isError() && res.getJson().dump() == parseJson(text).getJson().dump());
+    }
+
+    CHECK(!JsonFileBuffer("test/missing.json").isOpen());
+    CHECK(readJson("test/missing.json").isError());
+
+    // an empty file is opened, but is not a document
+    ofstream("build/test_read_file_empty.json").close();
+    CHECK(JsonFileBuffer("build/test_read_file_empty.json").isOpen());
+    CHECK(JsonFileBuffer("build/test_read_file_empty.json").size() == 0);
+    remove("build/test_read_file_empty.json");
+
+    // a pipe cannot be mapped or sized, it is read until the writer closes it
+    const char *fifo = "build/test_read_file.fifo";
+    remove(fifo);
+    CHECK(mkfifo(fifo, 0600) == 0);
+    string text = slurp("test/test2.json");
+    string big = "[" + text;
+    for (int i = 0; i < 50; i++)
+        big += "," + text;
+    big += "]";
+    thread writer([&] {
+        ofstream out(fifo, ios::binary);
+        out << big;
+    });
+    ParseResult res = readJson(fifo);
+    writer.join();
+    remove(fifo);
+    CHECK(!res.isError() && res.getJson().size() == 51);
+
+    return testResult("test_read_file");
+}
@@ -0,0 +1,61 @@
+// JsonPushParser against parseJson, with the input split at every byte boundary
+
+#include "test.h"
+#include "../src/json_stream.h"
+
+// feed s in two chunks split at k, or one byte at a time when k is npos
+static ParseResult pushParse(JsonPushParser &parser, string_view s, size_t k)
+{
+    parser.reset();
+    if (k == string_view::npos)
+    {
+        for (size_t i = 0; i < s.size(); i++)
+            parser.feed(s.substr(i, 1));
+    }
+    else
+    {
+        parser.feed(s.substr(0, k));
+        parser.feed(s.substr(k));
+    }
+    parser.finish();
+    return parser.result();
+}
+
+static void checkFile(const string &filepath)
+{
+    JsonFileBuffer file(filepath);
+    CHECK(file.isOpen());
+    string_view s = file.view();
+    ParseResult expected = parseJson(s);
+    CHECK(!expected.isError());
+    string dump = expected.getJson().dump();
+
+    JsonPushParser parser;
+    size_t mismatches = 0;
+    for (size_t k = 0; k <= s.size(); k++)
+    {
+        ParseResult res = pushParse(parser, s, k);
+        if (res.isError() || res.getJson().dump() != dump)
+        {
+            if (mismatches++ == 0)
+                cout << filepath << ": split at " << k << " differs" << endl;
+        }
+    }
+    CHECK(mismatches == 0);
+    ParseResult bytes = pushParse(parser, s, string_view::npos);
+    CHECK(!bytes.isError() && bytes.getJson().dump() == dump);
+}
+
+int main()
+{
+    checkFile("test/test1.json");
+    checkFile("test/test2.json");
+
+    // errors are reported wherever the input is split
+    JsonPushParser parser;
+    for (string bad : {"{\"a\":1,}x", "[1,2", "{\"a\" 1}", "[tru]", "\"abc", "[1] 2", "-"})
+        for (size_t k = 0; k <= bad.size(); k++)
+            CHECK(pushParse(parser, bad, k).isError());
+
+    return testResult("test_stream");
+}
@@ -0,0 +1,63 @@
+// many threads parsing different documents at the same time, each with its own JsonParser.
+// run it under ThreadSanitizer with make tsan
+
+#include <thread>
+#include "test.h"
+
+static const int threadCount = 8;
+static const int documentsPerThread = 300;
+
+// a document that only thread t produces for round i
+static Json makeDocument(int t, int i)
+{
+    Json doc = JsonObject();
+    doc["thread"] = t;
+    doc["round"] = i;
+    doc["name"] = "thread " + to_string(t) + " round " + to_string(i);
+    Json &values = doc["values"] = JsonArray();
+    for (int k = 0; k < (t + i) % 50; k++)
+        values.push_back(JsonObject(JsonPair{"k", k * t}, JsonPair{"x", k * 0.5 + i}, JsonPair{"s", string(k, 'a' + t)}));
+    return doc;
+}
+
+int main()
+{
+    string shared;
+    {
+        JsonFileBuffer file("test/test2.json");
+        CHECK(file.isOpen());
+        shared.assign(file.data(), file.size());
+    }
+    const string sharedDump = parseJson(shared).getJson().dump();
+
+    vector<int> failures(threadCount, 0);
+    vector<thread> pool;
+    for (int t = 0; t < threadCount; t++)
+    {
+        pool.emplace_back([&, t] {
+            JsonParser parser; // reused for every document of this thread
+            for (int i = 0; i < documentsPerThread; i++)
+            {
+                Json expected = makeDocument(t, i);
+                string text = expected.dump(t % 2, t % 2 ? "  " : "");
+                ParseResult res = parser.parse(text);
+                if (res.isError() || res.getJson().dump() != expected.dump())
+                    failures[t]++;
+                // all threads also read the same buffer, through both entry points
+                if (i % 20 == 0)
+                {
+                    ParseResult a = parser.parse(shared);
+                    ParseResult b = t % 2 ? parseJson(shared) : readJson("test/test2.json");
+                    if (a.isError() || b.isError() || a.getJson().dump() != sharedDump || b.getJson().dump() != sharedDump)
+                        failures[t]++;
+                }
+            }
+        });
+    }
+    for (auto &th : pool)
+        th.join();
+    for (int t = 0; t < threadCount; t++)
+        CHECK(failures[t] == 0);
+
+    return testResult("test_threads");
+}